@@ -0,0 +1,150 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Двунаправленная Дейкстра: прямой поиск от начала по исходящим рёбрам и обратный от цели
+// по обратному CSR. Каждый шаг расширяет фронт с меньшим минимумом; поиск останавливается,
+// когда сумма минимумов обоих фронтов не меньше лучшего найденного пути через общую вершину.
+template <typename Weight>
+class BidirectionalDijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>
+BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    // В обратном поиске prev_edge — ребро, которым вершина ведёт в сторону цели
+    std::vector<std::optional<RouteInternalData>> forward_routes(vertex_count);
+    std::vector<std::optional<RouteInternalData>> backward_routes(vertex_count);
+    std::vector<bool> forward_settled(vertex_count, false);
+    std::vector<bool> backward_settled(vertex_count, false);
+    MinQueue forward_queue;
+    MinQueue backward_queue;
+
+    forward_routes[from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    backward_routes[to] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    auto update_best = [&](VertexId vertex) {
+        if (forward_routes[vertex] && backward_routes[vertex]) {
+            const Weight weight = forward_routes[vertex]->weight + backward_routes[vertex]->weight;
+            if (!best_weight || weight < *best_weight) {
+                best_weight = weight;
+                meeting_vertex = vertex;
+            }
+        }
+    };
+    update_best(from);
+
+    auto step = [&](bool forward) {
+        MinQueue& queue = forward ? forward_queue : backward_queue;
+        auto& routes = forward ? forward_routes : backward_routes;
+        auto& settled = forward ? forward_settled : backward_settled;
+
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (settled[vertex]) {
+            return false;
+        }
+        settled[vertex] = true;
+
+        const Weight weight = routes[vertex]->weight;
+        const auto edge_ids = forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex);
+        for (const EdgeId edge_id : edge_ids) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const VertexId next_vertex = forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            auto& route = routes[next_vertex];
+            if (!route || candidate_weight < route->weight) {
+                route = RouteInternalData{candidate_weight, edge_id};
+                queue.push({candidate_weight, next_vertex});
+                update_best(next_vertex);
+            }
+        }
+        return true;
+    };
+
+    size_t settled_count = 0;
+    while (!forward_queue.empty() && !backward_queue.empty()) {
+        const Weight forward_min = forward_queue.top().first;
+        const Weight backward_min = backward_queue.top().first;
+        if (best_weight && !(forward_min + backward_min < *best_weight)) {
+            break;
+        }
+        if (step(!(backward_min < forward_min))) {
+            ++settled_count;
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = forward_routes[meeting_vertex]->prev_edge;
+         edge_id;
+         edge_id = forward_routes[graph_.GetEdge(*edge_id).from]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (std::optional<EdgeId> edge_id = backward_routes[meeting_vertex]->prev_edge;
+         edge_id;
+         edge_id = backward_routes[graph_.GetEdge(*edge_id).to]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges), settled_count};
+}
+
+}  // namespace graph
@@ -0,0 +1,61 @@
+#include "catalogue_builder.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace transport_catalogue {
+
+    CatalogueBuilder& CatalogueBuilder::AddStop(std::string_view name, geo::Coordinates coordinates) {
+        stops_.push_back({ name, coordinates });
+        return *this;
+    }
+
+    CatalogueBuilder& CatalogueBuilder::AddDistance(std::string_view from, std::string_view to, int distance) {
+        distances_.push_back({ from, to, distance });
+        return *this;
+    }
+
+    CatalogueBuilder& CatalogueBuilder::AddBus(std::string_view name, const std::vector<std::string_view>& stops,
+                                               bool is_circular) {
+        const size_t stops_begin = bus_stop_names_.size();
+        bus_stop_names_.insert(bus_stop_names_.end(), stops.begin(), stops.end());
+        buses_.push_back({ name, stops_begin, bus_stop_names_.size(), is_circular });
+        return *this;
+    }
+
+    TransportCatalogue CatalogueBuilder::Build(size_t thread_count) const {
+        TransportCatalogue catalogue;
+        catalogue.Reserve(stops_.size(), buses_.size(), bus_stop_names_.size(), distances_.size());
+
+        for (const auto& stop : stops_) {
+            catalogue.AddStop(stop.name, stop.coordinates);
+        }
+
+        // Расстояния до автобусов: по ним строятся префиксные суммы в AddBus
+        for (const auto& distance : distances_) {
+            const auto from = catalogue.FindStopId(distance.from);
+            const auto to = catalogue.FindStopId(distance.to);
+            if (from && to) {
+                catalogue.SetDistance(*from, *to, distance.distance);
+            }
+        }
+
+        std::vector<domain::StopId> bus_stops;
+        bus_stops.reserve(bus_stop_names_.size());
+        for (const auto& stop_name : bus_stop_names_) {
+            const auto stop = catalogue.FindStopId(stop_name);
+            if (!stop) {
+                throw std::out_of_range("Unknown stop: " + std::string(stop_name));
+            }
+            bus_stops.push_back(*stop);
+        }
+        for (const auto& bus : buses_) {
+            const domain::StopId* data = bus_stops.data();
+            catalogue.AddBus(bus.name, { data + bus.stops_begin, data + bus.stops_end }, bus.is_circular);
+        }
+
+        catalogue.Finalize(thread_count);
+        return catalogue;
+    }
+
+}  // namespace transport_catalogue
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "geo.h"
+#include "transport_catalogue.h"
+
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+    // Собирает остановки, расстояния и автобусы в любом порядке одной пачкой, а Build
+    // резервирует точные размеры, один раз переводит имена в id и возвращает готовый каталог.
+    // Переданные имена не копируются и должны жить до вызова Build.
+    class CatalogueBuilder {
+    public:
+        CatalogueBuilder& AddStop(std::string_view name, geo::Coordinates coordinates);
+        CatalogueBuilder& AddDistance(std::string_view from, std::string_view to, int distance);
+        CatalogueBuilder& AddBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_circular);
+
+        // Бросает std::out_of_range, если автобус проходит через неизвестную остановку
+        TransportCatalogue Build(size_t thread_count) const;
+
+    private:
+        struct StopEntry {
+            std::string_view name;
+            geo::Coordinates coordinates;
+        };
+
+        struct DistanceEntry {
+            std::string_view from;
+            std::string_view to;
+            int distance;
+        };
+
+        // Остановки автобуса — bus_stop_names_[stops_begin, stops_end)
+        struct BusEntry {
+            std::string_view name;
+            size_t stops_begin;
+            size_t stops_end;
+            bool is_circular;
+        };
+
+        std::vector<StopEntry> stops_;
+        std::vector<DistanceEntry> distances_;
+        std::vector<BusEntry> buses_;
+        std::vector<std::string_view> bus_stop_names_;
+    };
+
+}  // namespace transport_catalogue
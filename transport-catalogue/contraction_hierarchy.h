@@ -0,0 +1,458 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Contraction Hierarchies. Вершины по очереди стягиваются в порядке важности
+// (разность числа добавляемых шорткатов и удаляемых рёбер плюс число уже стянутых соседей),
+// а кратчайшие пути через стянутую вершину сохраняются шорткатами.
+// Запрос — двунаправленный поиск только вверх по рангу, шорткаты раскрываются
+// обратно в исходные рёбра графа.
+template <typename Weight>
+class ContractionHierarchyRouter : public RouterBase<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    explicit ContractionHierarchyRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    size_t GetShortcutCount() const {
+        return edges_.size() - original_edge_count_;
+    }
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    // Поиск свидетелей ограничен: при оценке приоритета он грубее, чем при самом стягивании.
+    // Не найденный свидетель даёт лишний шорткат, но не ошибку в ответе.
+    static constexpr size_t SIMULATION_SETTLED_LIMIT = 20;
+    static constexpr size_t CONTRACTION_SETTLED_LIMIT = 100;
+    static constexpr Weight ZERO_WEIGHT{};
+
+    // Исходное ребро хранит свой id в first, шорткат — два ребра иерархии, которые он заменяет
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct SearchLabels {
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+        std::vector<uint32_t> stamps;
+    };
+
+    void AddResidualEdge(EdgeId edge_id);
+    void RemoveContractedVertex(VertexId vertex);
+    void ContractGraph();
+    int64_t GetPriority(VertexId vertex);
+    size_t ContractVertex(VertexId vertex, bool simulate);
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight, size_t settled_limit);
+    void BuildSearchGraphs();
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    size_t vertex_count_;
+    size_t original_edge_count_;
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> ranks_;
+
+    // Остаточный граф и вспомогательные данные, нужные только на время стягивания
+    std::vector<std::vector<EdgeId>> out_edges_;
+    std::vector<std::vector<EdgeId>> in_edges_;
+    std::vector<int64_t> contracted_neighbors_;
+    std::vector<std::optional<Weight>> witness_weights_;
+    std::vector<VertexId> witness_touched_;
+
+    // Рёбра к вершинам с большим рангом: исходящие для прямого поиска, входящие для обратного
+    std::vector<size_t> upward_offsets_;
+    std::vector<EdgeId> upward_edges_;
+    std::vector<size_t> downward_offsets_;
+    std::vector<EdgeId> downward_edges_;
+
+    mutable std::mutex query_mutex_;
+    mutable SearchLabels forward_labels_;
+    mutable SearchLabels backward_labels_;
+    mutable uint32_t query_stamp_ = 0;
+};
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph)
+    : vertex_count_(graph.GetVertexCount())
+    , original_edge_count_(graph.GetEdgeCount())
+    , ranks_(vertex_count_)
+    , out_edges_(vertex_count_)
+    , in_edges_(vertex_count_)
+    , contracted_neighbors_(vertex_count_, 0)
+    , witness_weights_(vertex_count_)
+{
+    edges_.reserve(original_edge_count_);
+    for (EdgeId edge_id = 0; edge_id < original_edge_count_; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges_.push_back({edge.from, edge.to, edge.weight, edge_id, NO_EDGE});
+        if (edge.from != edge.to) {
+            AddResidualEdge(edge_id);
+        }
+    }
+
+    ContractGraph();
+    BuildSearchGraphs();
+
+    out_edges_ = {};
+    in_edges_ = {};
+    contracted_neighbors_ = {};
+    witness_weights_ = {};
+    witness_touched_ = {};
+
+    for (SearchLabels* labels : {&forward_labels_, &backward_labels_}) {
+        labels->weights.resize(vertex_count_);
+        labels->prev_edges.resize(vertex_count_);
+        labels->stamps.assign(vertex_count_, 0);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::ContractGraph() {
+    std::priority_queue<std::pair<int64_t, VertexId>, std::vector<std::pair<int64_t, VertexId>>,
+                        std::greater<std::pair<int64_t, VertexId>>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        queue.push({GetPriority(vertex), vertex});
+    }
+
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        // Ленивое обновление: приоритет мог вырасти после стягивания соседей
+        const int64_t priority = GetPriority(vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+
+        ContractVertex(vertex, false);
+        ranks_[vertex] = rank++;
+        RemoveContractedVertex(vertex);
+    }
+}
+
+// Из параллельных рёбер в остаточном графе остаётся только самое лёгкое
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::AddResidualEdge(EdgeId edge_id) {
+    const auto& edge = edges_[edge_id];
+    auto& out_edges = out_edges_[edge.from];
+    for (EdgeId& other_edge_id : out_edges) {
+        const auto& other_edge = edges_[other_edge_id];
+        if (other_edge.to != edge.to) {
+            continue;
+        }
+        if (!(edge.weight < other_edge.weight)) {
+            return;
+        }
+        auto& in_edges = in_edges_[edge.to];
+        *std::find(in_edges.begin(), in_edges.end(), other_edge_id) = edge_id;
+        other_edge_id = edge_id;
+        return;
+    }
+    out_edges.push_back(edge_id);
+    in_edges_[edge.to].push_back(edge_id);
+}
+
+// Рёбра к стянутой вершине больше не нужны ни поиску свидетелей, ни оценке приоритетов
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::RemoveContractedVertex(VertexId vertex) {
+    for (const EdgeId edge_id : out_edges_[vertex]) {
+        const VertexId target = edges_[edge_id].to;
+        ++contracted_neighbors_[target];
+        auto& in_edges = in_edges_[target];
+        in_edges.erase(std::remove_if(in_edges.begin(), in_edges.end(),
+                                      [&](EdgeId id) { return edges_[id].from == vertex; }),
+                       in_edges.end());
+    }
+    for (const EdgeId edge_id : in_edges_[vertex]) {
+        const VertexId source = edges_[edge_id].from;
+        ++contracted_neighbors_[source];
+        auto& out_edges = out_edges_[source];
+        out_edges.erase(std::remove_if(out_edges.begin(), out_edges.end(),
+                                       [&](EdgeId id) { return edges_[id].to == vertex; }),
+                        out_edges.end());
+    }
+    out_edges_[vertex] = {};
+    in_edges_[vertex] = {};
+}
+
+template <typename Weight>
+int64_t ContractionHierarchyRouter<Weight>::GetPriority(VertexId vertex) {
+    const auto removed_edges = static_cast<int64_t>(out_edges_[vertex].size() + in_edges_[vertex].size());
+    const auto shortcuts = static_cast<int64_t>(ContractVertex(vertex, true));
+    return shortcuts - removed_edges + contracted_neighbors_[vertex];
+}
+
+template <typename Weight>
+size_t ContractionHierarchyRouter<Weight>::ContractVertex(VertexId vertex, bool simulate) {
+    size_t shortcut_count = 0;
+
+    for (size_t in_index = 0; in_index < in_edges_[vertex].size(); ++in_index) {
+        const EdgeId in_edge_id = in_edges_[vertex][in_index];
+        const VertexId source = edges_[in_edge_id].from;
+        const Weight in_weight = edges_[in_edge_id].weight;
+
+        std::optional<Weight> max_out_weight;
+        for (const EdgeId out_edge_id : out_edges_[vertex]) {
+            const auto& out_edge = edges_[out_edge_id];
+            if (out_edge.to != source && (!max_out_weight || *max_out_weight < out_edge.weight)) {
+                max_out_weight = out_edge.weight;
+            }
+        }
+        if (!max_out_weight) {
+            continue;
+        }
+
+        RunWitnessSearch(source, vertex, in_weight + *max_out_weight,
+                         simulate ? SIMULATION_SETTLED_LIMIT : CONTRACTION_SETTLED_LIMIT);
+
+        for (size_t out_index = 0; out_index < out_edges_[vertex].size(); ++out_index) {
+            const EdgeId out_edge_id = out_edges_[vertex][out_index];
+            const VertexId target = edges_[out_edge_id].to;
+            if (target == source) {
+                continue;
+            }
+
+            const Weight shortcut_weight = in_weight + edges_[out_edge_id].weight;
+            if (const auto& witness_weight = witness_weights_[target];
+                witness_weight && !(shortcut_weight < *witness_weight)) {
+                continue;
+            }
+
+            ++shortcut_count;
+            if (!simulate) {
+                edges_.push_back({source, target, shortcut_weight, in_edge_id, out_edge_id});
+                AddResidualEdge(edges_.size() - 1);
+                // Следующие рёбра из source увидят этот шорткат как свидетеля
+                if (!witness_weights_[target]) {
+                    witness_touched_.push_back(target);
+                }
+                witness_weights_[target] = shortcut_weight;
+            }
+        }
+    }
+
+    return shortcut_count;
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight,
+                                                          size_t settled_limit) {
+    for (const VertexId vertex : witness_touched_) {
+        witness_weights_[vertex].reset();
+    }
+    witness_touched_.clear();
+
+    MinQueue queue;
+    witness_weights_[source] = ZERO_WEIGHT;
+    witness_touched_.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < settled_limit) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (*witness_weights_[vertex] < weight) {
+            continue;
+        }
+        if (max_weight < weight) {
+            break;
+        }
+        ++settled_count;
+
+        for (const EdgeId edge_id : out_edges_[vertex]) {
+            const auto& edge = edges_[edge_id];
+            if (edge.to == excluded) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            auto& target_weight = witness_weights_[edge.to];
+            if (!target_weight || candidate_weight < *target_weight) {
+                if (!target_weight) {
+                    witness_touched_.push_back(edge.to);
+                }
+                target_weight = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::BuildSearchGraphs() {
+    upward_offsets_.assign(vertex_count_ + 1, 0);
+    downward_offsets_.assign(vertex_count_ + 1, 0);
+    for (const auto& edge : edges_) {
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            ++upward_offsets_[edge.from + 1];
+        }
+        else if (ranks_[edge.to] < ranks_[edge.from]) {
+            ++downward_offsets_[edge.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        upward_offsets_[vertex + 1] += upward_offsets_[vertex];
+        downward_offsets_[vertex + 1] += downward_offsets_[vertex];
+    }
+
+    upward_edges_.resize(upward_offsets_.back());
+    downward_edges_.resize(downward_offsets_.back());
+    std::vector<size_t> upward_positions(upward_offsets_.begin(), upward_offsets_.end() - 1);
+    std::vector<size_t> downward_positions(downward_offsets_.begin(), downward_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const auto& edge = edges_[edge_id];
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            upward_edges_[upward_positions[edge.from]++] = edge_id;
+        }
+        else if (ranks_[edge.to] < ranks_[edge.from]) {
+            downward_edges_[downward_positions[edge.to]++] = edge_id;
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const auto& edge = edges_[stack.back()];
+        stack.pop_back();
+        if (edge.second == NO_EDGE) {
+            edges.push_back(edge.first);
+        }
+        else {
+            stack.push_back(edge.second);
+            stack.push_back(edge.first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchyRouter<Weight>::RouteInfo>
+ContractionHierarchyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::lock_guard lock(query_mutex_);
+    if (++query_stamp_ == 0) {
+        std::fill(forward_labels_.stamps.begin(), forward_labels_.stamps.end(), 0);
+        std::fill(backward_labels_.stamps.begin(), backward_labels_.stamps.end(), 0);
+        query_stamp_ = 1;
+    }
+
+    auto is_reached = [this](const SearchLabels& labels, VertexId vertex) {
+        return labels.stamps[vertex] == query_stamp_;
+    };
+    auto reach = [this](SearchLabels& labels, MinQueue& queue, VertexId vertex, Weight weight, EdgeId edge_id) {
+        labels.stamps[vertex] = query_stamp_;
+        labels.weights[vertex] = weight;
+        labels.prev_edges[vertex] = edge_id;
+        queue.push({weight, vertex});
+    };
+
+    MinQueue forward_queue;
+    MinQueue backward_queue;
+    reach(forward_labels_, forward_queue, from, ZERO_WEIGHT, NO_EDGE);
+    reach(backward_labels_, backward_queue, to, ZERO_WEIGHT, NO_EDGE);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = 0;
+
+    auto step = [&](bool forward) {
+        SearchLabels& labels = forward ? forward_labels_ : backward_labels_;
+        const SearchLabels& other_labels = forward ? backward_labels_ : forward_labels_;
+        MinQueue& queue = forward ? forward_queue : backward_queue;
+
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (labels.weights[vertex] < weight) {
+            return;
+        }
+        if (is_reached(other_labels, vertex)) {
+            const Weight candidate_weight = weight + other_labels.weights[vertex];
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+
+        const auto& offsets = forward ? upward_offsets_ : downward_offsets_;
+        const auto& search_edges = forward ? upward_edges_ : downward_edges_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const EdgeId edge_id = search_edges[i];
+            const auto& edge = edges_[edge_id];
+            const VertexId next_vertex = forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            if (!is_reached(labels, next_vertex) || candidate_weight < labels.weights[next_vertex]) {
+                reach(labels, queue, next_vertex, candidate_weight, edge_id);
+            }
+        }
+    };
+
+    // Направление останавливается, когда его минимум не меньше найденного пути
+    auto is_active = [&best_weight](const MinQueue& queue) {
+        return !queue.empty() && (!best_weight || queue.top().first < *best_weight);
+    };
+    while (is_active(forward_queue) || is_active(backward_queue)) {
+        const bool forward = !is_active(backward_queue)
+            || (is_active(forward_queue) && !(backward_queue.top().first < forward_queue.top().first));
+        step(forward);
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (EdgeId edge_id = forward_labels_.prev_edges[meeting_vertex];
+         edge_id != NO_EDGE;
+         edge_id = forward_labels_.prev_edges[edges_[edge_id].from])
+    {
+        hierarchy_edges.push_back(edge_id);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (EdgeId edge_id = backward_labels_.prev_edges[meeting_vertex];
+         edge_id != NO_EDGE;
+         edge_id = backward_labels_.prev_edges[edges_[edge_id].to])
+    {
+        hierarchy_edges.push_back(edge_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Ничего не предрасчитывает: каждый BuildRoute запускает Дейкстру с двоичной кучей.
+// Построение — O(E), запрос — O(E log V).
+// С эвристикой это A*: очередь упорядочена по весу от начала плюс нижней оценке до цели.
+// Оценка должна быть согласованной, иначе найденный путь может оказаться не кратчайшим.
+template <typename Weight>
+class DijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    using Heuristic = std::function<Weight(VertexId vertex, VertexId target)>;
+
+    explicit DijkstraRouter(const Graph& graph, Heuristic heuristic = nullptr);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Heuristic heuristic_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<std::optional<RouteInternalData>> routes(vertex_count);
+    std::vector<bool> settled(vertex_count, false);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    auto get_priority = [this, to](Weight weight, VertexId vertex) {
+        return heuristic_ ? weight + heuristic_(vertex, to) : weight;
+    };
+
+    routes[from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.push({get_priority(ZERO_WEIGHT, from), from});
+
+    size_t settled_count = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        ++settled_count;
+        if (vertex == to) {
+            break;
+        }
+
+        const Weight weight = routes[vertex]->weight;
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            auto& route = routes[edge.to];
+            if (!route || candidate_weight < route->weight) {
+                route = RouteInternalData{candidate_weight, edge_id};
+                queue.push({get_priority(candidate_weight, edge.to), edge.to});
+            }
+        }
+    }
+
+    if (!routes[to]) {
+        return std::nullopt;
+    }
+    const Weight weight = routes[to]->weight;
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = routes[to]->prev_edge;
+         edge_id;
+         edge_id = routes[graph_.GetEdge(*edge_id).from]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges), settled_count};
+}
+
+}  // namespace graph
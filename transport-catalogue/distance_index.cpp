@@ -0,0 +1,111 @@
+#include "distance_index.h"
+#include <algorithm>
+
+namespace transport_catalogue {
+
+    void DistanceIndex::Reserve(size_t count) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < count * 2) {
+            capacity *= 2;
+        }
+        if (capacity > slots_.size()) {
+            Rehash(capacity);
+        }
+    }
+
+    void DistanceIndex::Set(domain::StopId from, domain::StopId to, int distance) {
+        // Заполнение не выше половины держит цепочки проб короткими
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Rehash(std::max(MIN_CAPACITY, slots_.size() * 2));
+        }
+
+        const uint64_t key = GetKey(from, to);
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = GetStartSlot(from, to);; slot = (slot + 1) & mask) {
+            if (slots_[slot].key == key) {
+                slots_.MutableData()[slot].distance = distance;
+                return;
+            }
+            if (slots_[slot].key == EMPTY_KEY) {
+                slots_.MutableData()[slot] = { key, distance };
+                ++size_;
+                return;
+            }
+        }
+    }
+
+    std::optional<int> DistanceIndex::Find(domain::StopId from, domain::StopId to) const {
+        if (slots_.empty()) {
+            return std::nullopt;
+        }
+
+        const uint64_t key = GetKey(from, to);
+        const uint64_t reverse_key = GetKey(to, from);
+        const size_t mask = slots_.size() - 1;
+        std::optional<int> reverse_distance;
+        for (size_t slot = GetStartSlot(from, to); slots_[slot].key != EMPTY_KEY; slot = (slot + 1) & mask) {
+            if (slots_[slot].key == key) {
+                return slots_[slot].distance;
+            }
+            if (slots_[slot].key == reverse_key) {
+                reverse_distance = slots_[slot].distance;
+            }
+        }
+        return reverse_distance;
+    }
+
+    size_t DistanceIndex::GetSize() const {
+        return size_;
+    }
+
+    const DistanceIndex::Slot* DistanceIndex::GetSlots() const {
+        return slots_.data();
+    }
+
+    size_t DistanceIndex::GetCapacity() const {
+        return slots_.size();
+    }
+
+    bool DistanceIndex::Attach(const Slot* slots, size_t capacity, size_t size) {
+        if ((capacity & (capacity - 1)) != 0 || (capacity == 0 && size > 0) || size * 2 > capacity) {
+            return false;
+        }
+        // Заголовку не верим: поиск останавливается только на пустом слоте,
+        // поэтому занятых слотов должно быть ровно size, не больше половины таблицы
+        size_t occupied = 0;
+        for (size_t slot = 0; slot < capacity; ++slot) {
+            occupied += slots[slot].key != EMPTY_KEY;
+        }
+        if (occupied != size) {
+            return false;
+        }
+        slots_.Attach(slots, capacity);
+        size_ = size;
+        return true;
+    }
+
+    uint64_t DistanceIndex::GetKey(domain::StopId from, domain::StopId to) {
+        return (static_cast<uint64_t>(from) << 32) | to;
+    }
+
+    size_t DistanceIndex::GetStartSlot(domain::StopId from, domain::StopId to) const {
+        // Финализатор splitmix64 от упорядоченной пары
+        uint64_t hash = GetKey(std::min(from, to), std::max(from, to));
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return static_cast<size_t>(hash) & (slots_.size() - 1);
+    }
+
+    void DistanceIndex::Rehash(size_t capacity) {
+        const mapped_file::MappedArray<Slot> old_slots = std::move(slots_);
+        slots_.assign(capacity, Slot{ EMPTY_KEY, 0 });
+        size_ = 0;
+        for (const Slot& slot : old_slots) {
+            if (slot.key != EMPTY_KEY) {
+                Set(static_cast<domain::StopId>(slot.key >> 32), static_cast<domain::StopId>(slot.key), slot.distance);
+            }
+        }
+    }
+
+}  // namespace transport_catalogue
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "domain.h"
+#include "mapped_array.h"
+
+namespace transport_catalogue {
+
+    // Дорожные расстояния между парами остановок: открытая адресация с линейным пробированием.
+    // Ключ — упакованная пара (from, to), а позиция в таблице зависит только от неупорядоченной
+    // пары, поэтому (A, B) и (B, A) лежат на одной цепочке проб, и обратное направление
+    // находится тем же проходом.
+    class DistanceIndex {
+    public:
+        struct Slot {
+            uint64_t key;
+            int distance;
+        };
+
+        // Готовит место под count пар без перестроек таблицы
+        void Reserve(size_t count);
+        void Set(domain::StopId from, domain::StopId to, int distance);
+
+        // Расстояние from -> to, если оно задано, иначе to -> from
+        std::optional<int> Find(domain::StopId from, domain::StopId to) const;
+
+        size_t GetSize() const;
+
+        // Таблица целиком — для снимка каталога
+        const Slot* GetSlots() const;
+        size_t GetCapacity() const;
+        // Читает таблицу прямо из чужой памяти; false, если ёмкость не степень двойки
+        // или число занятых слотов не равно size либо больше половины ёмкости
+        bool Attach(const Slot* slots, size_t capacity, size_t size);
+
+    private:
+
+        static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+        static constexpr size_t MIN_CAPACITY = 16;
+
+        static uint64_t GetKey(domain::StopId from, domain::StopId to);
+        size_t GetStartSlot(domain::StopId from, domain::StopId to) const;
+        void Rehash(size_t capacity);
+
+        mapped_file::MappedArray<Slot> slots_;
+        size_t size_ = 0;
+    };
+
+}  // namespace transport_catalogue
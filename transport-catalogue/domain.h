@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <string_view>
@@ -7,16 +8,9 @@
 
 namespace domain {
 
-    struct Stop {
-        std::string name;
-        geo::Coordinates coordinates;
-    };
-
-    struct Bus {
-        std::string name;
-        std::vector<std::string_view> stops;
-        bool is_circular;
-    };
+    // Плотные номера остановок и автобусов в порядке добавления в каталог
+    using StopId = uint32_t;
+    using BusId = uint32_t;
 
     struct BusInfo {
         std::string name;
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "graph.h"
+#include "relax_kernel.h"
+#include "router.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Тот же предрасчёт всех пар, что и в Router, но в двух плотных построчных матрицах:
+// float-веса и 32-битные id последних рёбер. Отсутствие маршрута — бесконечный вес,
+// отсутствие ребра — NO_EDGE. Ячейка занимает 8 байт вместо ~32.
+// При thread_count > 1 матрица считается блочным Флойдом — Уоршеллом на пуле потоков.
+// Внутренний цикл по строке выполняет векторное ядро из relax_kernel.h.
+// Готовые матрицы можно сохранить и затем читать прямо из внешней памяти, например из mmap.
+template <typename Weight>
+class FlatRouter : public RouterBase<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+    using CompactWeight = float;
+    using CompactEdgeId = uint32_t;
+
+    explicit FlatRouter(const Graph& graph, size_t thread_count = 1);
+    // Матрицы не копируются: память размером V * V элементов должна пережить маршрутизатор
+    FlatRouter(const Graph& graph, const CompactWeight* weights, const CompactEdgeId* prev_edges);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Проверяет чужие матрицы: каждое ребро предыдущего шага существует и ведёт в вершину своей ячейки.
+    // Циклы так не исключить, поэтому BuildRoute ещё и ограничивает путь числом вершин
+    bool HasValidTables() const;
+
+    const CompactWeight* GetWeights() const {
+        return weights_view_;
+    }
+    const CompactEdgeId* GetPrevEdges() const {
+        return prev_edges_view_;
+    }
+
+private:
+
+    static constexpr CompactWeight INFINITE_WEIGHT = std::numeric_limits<CompactWeight>::infinity();
+    static constexpr CompactEdgeId NO_EDGE = std::numeric_limits<CompactEdgeId>::max();
+    static constexpr size_t TILE_SIZE = 64;
+
+    size_t GetIndex(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    void InitializeRoutesInternalData() {
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            weights_[GetIndex(vertex, vertex)] = 0;
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (edge.weight < Weight{}) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const size_t index = GetIndex(vertex, edge.to);
+                const auto weight = static_cast<CompactWeight>(edge.weight);
+                if (weight < weights_[index]) {
+                    weights_[index] = weight;
+                    prev_edges_[index] = static_cast<CompactEdgeId>(edge_id);
+                }
+            }
+        }
+    }
+
+    // Ячейка (from, to) улучшается только при to != through, а значит,
+    // у маршрута through -> to всегда есть последнее ребро.
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_through) {
+        const CompactWeight* weights_through = &weights_[GetIndex(vertex_through, 0)];
+        const CompactEdgeId* prev_edges_through = &prev_edges_[GetIndex(vertex_through, 0)];
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            const CompactWeight weight_from = weights_[GetIndex(vertex_from, vertex_through)];
+            if (weight_from == INFINITE_WEIGHT) {
+                continue;
+            }
+            relax_row_(weight_from, weights_through, prev_edges_through,
+                       &weights_[GetIndex(vertex_from, 0)], &prev_edges_[GetIndex(vertex_from, 0)], vertex_count_);
+        }
+    }
+
+    // Релаксация клетки (row_tile, column_tile) через вершины клетки through_tile
+    void RelaxTile(size_t row_tile, size_t column_tile, size_t through_tile) {
+        const VertexId row_end = std::min(vertex_count_, (row_tile + 1) * TILE_SIZE);
+        const VertexId column_begin = column_tile * TILE_SIZE;
+        const VertexId column_end = std::min(vertex_count_, column_begin + TILE_SIZE);
+        const VertexId through_end = std::min(vertex_count_, (through_tile + 1) * TILE_SIZE);
+
+        for (VertexId vertex_through = through_tile * TILE_SIZE; vertex_through < through_end; ++vertex_through) {
+            const CompactWeight* weights_through = &weights_[GetIndex(vertex_through, 0)];
+            const CompactEdgeId* prev_edges_through = &prev_edges_[GetIndex(vertex_through, 0)];
+            for (VertexId vertex_from = row_tile * TILE_SIZE; vertex_from < row_end; ++vertex_from) {
+                const CompactWeight weight_from = weights_[GetIndex(vertex_from, vertex_through)];
+                if (weight_from == INFINITE_WEIGHT) {
+                    continue;
+                }
+                relax_row_(weight_from, weights_through + column_begin, prev_edges_through + column_begin,
+                           &weights_[GetIndex(vertex_from, column_begin)],
+                           &prev_edges_[GetIndex(vertex_from, column_begin)],
+                           column_end - column_begin);
+            }
+        }
+    }
+
+    // Для каждой диагональной клетки: сначала она сама, затем её строка и столбец,
+    // затем все остальные клетки. Внутри второй и третьей фазы клетки независимы.
+    void RelaxRoutesInternalDataBlocked(thread_pool::ThreadPool& pool) {
+        const size_t tile_count = (vertex_count_ + TILE_SIZE - 1) / TILE_SIZE;
+        for (size_t through_tile = 0; through_tile < tile_count; ++through_tile) {
+            RelaxTile(through_tile, through_tile, through_tile);
+
+            pool.ParallelFor(2 * tile_count, [&](size_t task) {
+                const size_t tile = task % tile_count;
+                if (tile == through_tile) {
+                    return;
+                }
+                if (task < tile_count) {
+                    RelaxTile(through_tile, tile, through_tile);
+                }
+                else {
+                    RelaxTile(tile, through_tile, through_tile);
+                }
+            });
+
+            pool.ParallelFor(tile_count * tile_count, [&](size_t task) {
+                const size_t row_tile = task / tile_count;
+                const size_t column_tile = task % tile_count;
+                if (row_tile != through_tile && column_tile != through_tile) {
+                    RelaxTile(row_tile, column_tile, through_tile);
+                }
+            });
+        }
+    }
+
+    const Graph& graph_;
+    size_t vertex_count_;
+    RelaxRowFunction relax_row_ = GetRelaxRowFunction();
+    std::vector<CompactWeight> weights_;
+    std::vector<CompactEdgeId> prev_edges_;
+    // Запросы читают матрицы через эти указатели: на собственные векторы или на внешнюю память
+    const CompactWeight* weights_view_ = nullptr;
+    const CompactEdgeId* prev_edges_view_ = nullptr;
+};
+
+template <typename Weight>
+FlatRouter<Weight>::FlatRouter(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for 32-bit edge ids");
+    }
+    weights_.assign(vertex_count_ * vertex_count_, INFINITE_WEIGHT);
+    prev_edges_.assign(vertex_count_ * vertex_count_, NO_EDGE);
+
+    InitializeRoutesInternalData();
+    if (thread_count > 1) {
+        thread_pool::ThreadPool pool(thread_count);
+        RelaxRoutesInternalDataBlocked(pool);
+    }
+    else {
+        for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+            RelaxRoutesInternalDataThroughVertex(vertex_through);
+        }
+    }
+    weights_view_ = weights_.data();
+    prev_edges_view_ = prev_edges_.data();
+}
+
+template <typename Weight>
+FlatRouter<Weight>::FlatRouter(const Graph& graph, const CompactWeight* weights, const CompactEdgeId* prev_edges)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , weights_view_(weights)
+    , prev_edges_view_(prev_edges)
+{
+}
+
+template <typename Weight>
+std::optional<typename FlatRouter<Weight>::RouteInfo> FlatRouter<Weight>::BuildRoute(VertexId from,
+                                                                                     VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (weights_view_[GetIndex(from, to)] == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    // Вес пересчитывается по исходным рёбрам, чтобы не терять точность float
+    Weight weight{};
+    std::vector<EdgeId> edges;
+    for (CompactEdgeId edge_id = prev_edges_view_[GetIndex(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_view_[GetIndex(from, graph_.GetEdge(edge_id).from)])
+    {
+        // Кратчайший путь не длиннее числа вершин; длиннее — только по испорченным матрицам
+        if (edges.size() == vertex_count_) {
+            return std::nullopt;
+        }
+        edges.push_back(edge_id);
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+bool FlatRouter<Weight>::HasValidTables() const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (VertexId from = 0; from < vertex_count_; ++from) {
+        for (VertexId to = 0; to < vertex_count_; ++to) {
+            const CompactEdgeId edge_id = prev_edges_view_[GetIndex(from, to)];
+            if (edge_id != NO_EDGE && (edge_id >= edge_count || graph_.GetEdge(edge_id).to != to)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace graph
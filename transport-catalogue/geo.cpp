@@ -1,16 +1,111 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEO_KERNEL_X86
+#include <immintrin.h>
+#endif
+
 namespace geo {
 
+    namespace {
+
+        using DotProductsFunction = void (*)(const UnitVector* points, const uint32_t* from, const uint32_t* to,
+                                             double* dots, size_t count);
+
+        void DotProductsScalar(const UnitVector* points, const uint32_t* from, const uint32_t* to,
+                               double* dots, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const UnitVector& lhs = points[from[i]];
+                const UnitVector& rhs = points[to[i]];
+                dots[i] = lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+            }
+        }
+
+#ifdef GEO_KERNEL_X86
+        static_assert(sizeof(UnitVector) == 3 * sizeof(double));
+
+        // Маскированный gather с явным нулевым источником: у _mm256_i32gather_pd источник
+        // не инициализирован, и GCC предупреждает -Wmaybe-uninitialized
+        __attribute__((target("avx2")))
+        inline __m256d Gather(const double* base, __m128i indices) {
+            const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, indices, all, 8);
+        }
+
+        // Четыре пары за шаг: координаты собираются gather по индексам, умноженным на 3
+        __attribute__((target("avx2,fma")))
+        void DotProductsAvx2(const UnitVector* points, const uint32_t* from, const uint32_t* to,
+                             double* dots, size_t count) {
+            const double* base = &points[0].x;
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i lhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                __m128i rhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+                lhs = _mm_add_epi32(lhs, _mm_slli_epi32(lhs, 1));
+                rhs = _mm_add_epi32(rhs, _mm_slli_epi32(rhs, 1));
+
+                __m256d dot = _mm256_mul_pd(Gather(base, lhs), Gather(base, rhs));
+                dot = _mm256_fmadd_pd(Gather(base + 1, lhs), Gather(base + 1, rhs), dot);
+                dot = _mm256_fmadd_pd(Gather(base + 2, lhs), Gather(base + 2, rhs), dot);
+                _mm256_storeu_pd(dots + i, dot);
+            }
+            // Компилятор здесь сам не очищает верхние половины регистров, а без этого
+            // следующие за ядром SSE-вызовы acos из libm замедляются в разы
+            _mm256_zeroupper();
+            DotProductsScalar(points, from + i, to + i, dots + i, count - i);
+        }
+
+        DotProductsFunction DetectDotProductsFunction() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                return DotProductsAvx2;
+            }
+            return DotProductsScalar;
+        }
+#else
+        DotProductsFunction DetectDotProductsFunction() {
+            return DotProductsScalar;
+        }
+#endif
+
+        // Для совпадающих точек погрешность округления может вывести аргумент acos за единицу
+        double ComputeCentralAngle(double cosine) {
+            return std::acos(std::min(1.0, cosine));
+        }
+
+    }  // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.0;
-        return acos(sin(from.lat * dr) * sin(to.lat * dr)
+        return ComputeCentralAngle(sin(from.lat * dr) * sin(to.lat * dr)
             + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-            * 6371000;
+            * EARTH_RADIUS;
+    }
+
+    UnitVector ToUnitVector(Coordinates coordinates) {
+        const double dr = M_PI / 180.0;
+        const double cos_lat = std::cos(coordinates.lat * dr);
+        return { cos_lat * std::cos(coordinates.lng * dr),
+                 cos_lat * std::sin(coordinates.lng * dr),
+                 std::sin(coordinates.lat * dr) };
+    }
+
+    double ComputeDistance(const UnitVector& from, const UnitVector& to) {
+        return ComputeCentralAngle(from.x * to.x + from.y * to.y + from.z * to.z) * EARTH_RADIUS;
+    }
+
+    void ComputeDistances(const UnitVector* points, const uint32_t* from, const uint32_t* to,
+                          double* distances, size_t count) {
+        static const DotProductsFunction dot_products = DetectDotProductsFunction();
+        dot_products(points, from, to, distances, count);
+        for (size_t i = 0; i < count; ++i) {
+            distances[i] = ComputeCentralAngle(distances[i]) * EARTH_RADIUS;
+        }
     }
 
-}  // namespace geo
\ No newline at end of file
+}  // namespace geo
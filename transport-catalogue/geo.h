@@ -1,16 +1,38 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 
 namespace geo {
 
+    // Средний радиус Земли в метрах
+    inline constexpr double EARTH_RADIUS = 6371000;
+
     struct Coordinates {
         double lat; // Широта
         double lng; // Долгота
     };
 
+    // Точка на единичной сфере. Скалярное произведение двух таких векторов равно косинусу
+    // центрального угла из ComputeDistance, поэтому синусы и косинусы считаются один раз на точку.
+    struct UnitVector {
+        double x;
+        double y;
+        double z;
+    };
+
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    UnitVector ToUnitVector(Coordinates coordinates);
+    double ComputeDistance(const UnitVector& from, const UnitVector& to);
+
+    // distances[i] — расстояние между points[from[i]] и points[to[i]] для i из [0, count).
+    // Скалярные произведения считает векторное ядро (AVX2 с FMA, если процессор умеет), acos — поэлементно.
+    // Результат совпадает с ComputeDistance по координатам с точностью до погрешности округления.
+    void ComputeDistances(const UnitVector* points, const uint32_t* from, const uint32_t* to,
+                          double* distances, size_t count);
+
     inline bool IsZero(double value) {
         return std::abs(value) < 1e-6;
     }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "mapped_array.h"
 #include "ranges.h"
 
 #include <cstdlib>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -38,6 +40,67 @@ private:
     std::vector<IncidenceList> incidence_lists_;
 };
 
+// Неизменяемый граф в формате CSR: рёбра каждой вершины лежат подряд в одном массиве.
+// Строится один раз из DirectedWeightedGraph, id рёбер сохраняются.
+// Хранит и обратный CSR — входящие рёбра каждой вершины — для поисков от цели.
+// Доступ без проверки границ — id приходят из самого графа.
+template <typename Weight>
+class CsrGraph {
+private:
+    using IncidentEdgesRange = ranges::Range<const EdgeId*>;
+
+public:
+    // Массивы CSR как есть: по ним пишется снимок, и на них же граф собирается обратно.
+    // offsets и incoming_offsets длины vertex_count + 1, остальные — edge_count
+    struct Arrays {
+        size_t vertex_count;
+        size_t edge_count;
+        const Edge<Weight>* edges;
+        const size_t* offsets;
+        const EdgeId* incident_edges;
+        const size_t* incoming_offsets;
+        const EdgeId* incoming_edges;
+    };
+
+    CsrGraph() = default;
+    explicit CsrGraph(const DirectedWeightedGraph<Weight>& graph);
+    CsrGraph(size_t vertex_count, std::vector<Edge<Weight>> edges);
+
+    Arrays GetArrays() const;
+    // Смотрит на чужие массивы, ничего не копируя; они должны жить дольше графа.
+    // false, если массивы не образуют корректный CSR — тогда граф остаётся прежним
+    bool Attach(const Arrays& arrays);
+
+    size_t GetVertexCount() const {
+        return offsets_.empty() ? 0 : offsets_.size() - 1;
+    }
+    size_t GetEdgeCount() const {
+        return edges_.size();
+    }
+    const Edge<Weight>& GetEdge(EdgeId edge_id) const {
+        return edges_[edge_id];
+    }
+    IncidentEdgesRange GetIncidentEdges(VertexId vertex) const {
+        const EdgeId* data = incident_edges_.data();
+        return {data + offsets_[vertex], data + offsets_[vertex + 1]};
+    }
+    IncidentEdgesRange GetIncomingEdges(VertexId vertex) const {
+        const EdgeId* data = incoming_edges_.data();
+        return {data + incoming_offsets_[vertex], data + incoming_offsets_[vertex + 1]};
+    }
+
+private:
+    // Каждая вершина перечисляет ровно свои рёбра: from для исходящих и to для входящих
+    static bool IsValidIndex(size_t vertex_count, size_t edge_count, const Edge<Weight>* edges,
+                             const size_t* offsets, const EdgeId* edge_ids, bool incoming);
+
+    mapped_file::MappedArray<Edge<Weight>> edges_;
+    mapped_file::MappedArray<size_t> offsets_;
+    mapped_file::MappedArray<EdgeId> incident_edges_;
+    mapped_file::MappedArray<size_t> incoming_offsets_;
+    mapped_file::MappedArray<EdgeId> incoming_edges_;
+};
+
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
     : incidence_lists_(vertex_count) {
@@ -71,4 +134,94 @@ typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
-}  // namespace graph
\ No newline at end of file
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph) {
+    std::vector<Edge<Weight>> edges;
+    edges.reserve(graph.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        edges.push_back(graph.GetEdge(edge_id));
+    }
+    *this = CsrGraph(graph.GetVertexCount(), std::move(edges));
+}
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(size_t vertex_count, std::vector<Edge<Weight>> edges) {
+    std::vector<size_t> offsets(vertex_count + 1, 0);
+    std::vector<size_t> incoming_offsets(vertex_count + 1, 0);
+    for (const auto& edge : edges) {
+        ++offsets[edge.from + 1];
+        ++incoming_offsets[edge.to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets[vertex + 1] += offsets[vertex];
+        incoming_offsets[vertex + 1] += incoming_offsets[vertex];
+    }
+
+    // Рёбра раскладываются по возрастанию id — тот же порядок, что и в DirectedWeightedGraph
+    std::vector<EdgeId> incident_edges(edges.size());
+    std::vector<EdgeId> incoming_edges(edges.size());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    std::vector<size_t> incoming_positions(incoming_offsets.begin(), incoming_offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        incident_edges[positions[edges[edge_id].from]++] = edge_id;
+        incoming_edges[incoming_positions[edges[edge_id].to]++] = edge_id;
+    }
+
+    edges_ = mapped_file::MappedArray<Edge<Weight>>(std::move(edges));
+    offsets_ = mapped_file::MappedArray<size_t>(std::move(offsets));
+    incident_edges_ = mapped_file::MappedArray<EdgeId>(std::move(incident_edges));
+    incoming_offsets_ = mapped_file::MappedArray<size_t>(std::move(incoming_offsets));
+    incoming_edges_ = mapped_file::MappedArray<EdgeId>(std::move(incoming_edges));
+}
+
+template <typename Weight>
+typename CsrGraph<Weight>::Arrays CsrGraph<Weight>::GetArrays() const {
+    return {GetVertexCount(), GetEdgeCount(), edges_.data(), offsets_.data(),
+            incident_edges_.data(), incoming_offsets_.data(), incoming_edges_.data()};
+}
+
+template <typename Weight>
+bool CsrGraph<Weight>::Attach(const Arrays& arrays) {
+    const size_t vertex_count = arrays.vertex_count;
+    const size_t edge_count = arrays.edge_count;
+    for (size_t edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (arrays.edges[edge_id].from >= vertex_count || arrays.edges[edge_id].to >= vertex_count) {
+            return false;
+        }
+    }
+    if (!IsValidIndex(vertex_count, edge_count, arrays.edges, arrays.offsets, arrays.incident_edges, false)
+        || !IsValidIndex(vertex_count, edge_count, arrays.edges, arrays.incoming_offsets, arrays.incoming_edges, true))
+    {
+        return false;
+    }
+
+    edges_.Attach(arrays.edges, edge_count);
+    offsets_.Attach(arrays.offsets, vertex_count + 1);
+    incident_edges_.Attach(arrays.incident_edges, edge_count);
+    incoming_offsets_.Attach(arrays.incoming_offsets, vertex_count + 1);
+    incoming_edges_.Attach(arrays.incoming_edges, edge_count);
+    return true;
+}
+
+template <typename Weight>
+bool CsrGraph<Weight>::IsValidIndex(size_t vertex_count, size_t edge_count, const Edge<Weight>* edges,
+                                    const size_t* offsets, const EdgeId* edge_ids, bool incoming) {
+    if (offsets[0] != 0 || offsets[vertex_count] != edge_count) {
+        return false;
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (offsets[vertex] > offsets[vertex + 1] || offsets[vertex + 1] > edge_count) {
+            return false;
+        }
+        for (size_t position = offsets[vertex]; position < offsets[vertex + 1]; ++position) {
+            const EdgeId edge_id = edge_ids[position];
+            if (edge_id >= edge_count || (incoming ? edges[edge_id].to : edges[edge_id].from) != vertex) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace graph
@@ -1,222 +1,340 @@
 #include "json.h"
 
-#include <iterator>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string_view>
+#include <utility>
 
 namespace json {
 
+    using namespace std::literals;
+
     namespace {
-        using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        // Разбор указателем по окну буфера, без вызовов потока на каждый символ.
+        // Парсер не строит узлы, а сообщает события обработчику. Грамматика и сообщения ParsingError
+        // те же, что были у разбора из std::istream: ReadNonSpace повторяет input >> c, а Unread — putback.
+        // При чтении из потока окно подкачивается кусками; начало текущей лексемы (mark_)
+        // при подкачке сохраняется, поэтому лексема всегда лежит в буфере целиком.
+        template <typename EventHandler>
+        class Parser {
+        public:
+            Parser(std::string_view input, EventHandler& handler)
+                : handler_(handler)
+                , pos_(input.data())
+                , end_(input.data() + input.size()) {
+            }
 
-        std::string LoadLiteral(std::istream& input) {
-            std::string s;
-            while (std::isalpha(input.peek())) {
-                s.push_back(static_cast<char>(input.get()));
+            Parser(std::istream& input, EventHandler& handler)
+                : handler_(handler)
+                , stream_(&input) {
             }
-            return s;
-        }
 
-        Node LoadArray(std::istream& input) {
-            std::vector<Node> result;
+            void ParseNode() {
+                char c;
+                if (!ReadNonSpace(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                switch (c) {
+                case '[':
+                    ParseArray();
+                    break;
+                case '{':
+                    ParseDict();
+                    break;
+                case '"':
+                    handler_.String(ParseStringValue());
+                    break;
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    Unread();
+                    ParseBool();
+                    break;
+                case 'n':
+                    Unread();
+                    ParseNull();
+                    break;
+                default:
+                    Unread();
+                    ParseNumber();
+                    break;
+                }
+            }
+
+        private:
+            static constexpr size_t CHUNK_SIZE = 64 * 1024;
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+            // Дочитывает следующий кусок потока; false, если читать больше нечего
+            bool Refill() {
+                if (!stream_) {
+                    return false;
+                }
+                const char* keep = mark_ ? mark_ : pos_;
+                const size_t kept = static_cast<size_t>(end_ - keep);
+                const size_t pos_offset = static_cast<size_t>(pos_ - keep);
+                if (kept > 0) {
+                    std::memmove(buffer_.data(), keep, kept);
+                }
+                if (buffer_.size() < kept + CHUNK_SIZE) {
+                    buffer_.resize(kept + CHUNK_SIZE);
                 }
-                result.push_back(LoadNode(input));
+                stream_->read(buffer_.data() + kept, CHUNK_SIZE);
+                const auto read = static_cast<size_t>(stream_->gcount());
+
+                if (mark_) {
+                    mark_ = buffer_.data();
+                }
+                pos_ = buffer_.data() + pos_offset;
+                end_ = buffer_.data() + kept + read;
+                return read > 0;
             }
-            if (!input) {
-                throw ParsingError("Array parsing error"s);
+
+            bool AtEnd() {
+                return pos_ == end_ && !Refill();
             }
-            return Node(std::move(result));
-        }
 
-        Node LoadDict(std::istream& input) {
-            Dict dict;
+            bool ReadNonSpace(char& c) {
+                while (!AtEnd() && std::isspace(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
+                }
+                if (AtEnd()) {
+                    return false;
+                }
+                c = *pos_++;
+                return true;
+            }
+
+            void Unread() {
+                --pos_;
+            }
+
+            bool IsNext(int (*predicate)(int)) {
+                return !AtEnd() && predicate(static_cast<unsigned char>(*pos_));
+            }
+
+            bool IsNext(char c) {
+                return !AtEnd() && *pos_ == c;
+            }
+
+            std::string_view ParseLiteral() {
+                mark_ = pos_;
+                while (IsNext(std::isalpha)) {
+                    ++pos_;
+                }
+                const std::string_view literal(mark_, static_cast<size_t>(pos_ - mark_));
+                mark_ = nullptr;
+                return literal;
+            }
+
+            void ParseArray() {
+                handler_.StartArray();
+
+                char c;
+                bool is_closed = false;
+                while (ReadNonSpace(c)) {
+                    if (c == ']') {
+                        is_closed = true;
+                        break;
+                    }
+                    if (c != ',') {
+                        Unread();
+                    }
+                    ParseNode();
+                }
+                if (!is_closed) {
+                    throw ParsingError("Array parsing error"s);
+                }
+                handler_.EndArray();
+            }
+
+            void ParseDict() {
+                handler_.StartDict();
 
-            for (char c; input >> c && c != '}';) {
-                if (c == '"') {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':') {
-                        if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
+                char c;
+                bool is_closed = false;
+                while (ReadNonSpace(c)) {
+                    if (c == '}') {
+                        is_closed = true;
+                        break;
+                    }
+                    if (c == '"') {
+                        // Ключ копируется: до ':' окно может подкачаться
+                        std::string key(ParseStringValue());
+                        if (ReadNonSpace(c) && c == ':') {
+                            handler_.Key(key);
+                            ParseNode();
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
                         }
-                        dict.emplace(std::move(key), LoadNode(input));
                     }
-                    else {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
                     }
                 }
-                else if (c != ',') {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                if (!is_closed) {
+                    throw ParsingError("Dictionary parsing error"s);
                 }
+                handler_.EndDict();
             }
-            if (!input) {
-                throw ParsingError("Dictionary parsing error"s);
+
+            // Пропускает символы строки до кавычки, обратной косой черты или конца строки
+            void SkipStringRun() {
+                do {
+                    while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\' && *pos_ != '\n' && *pos_ != '\r') {
+                        ++pos_;
+                    }
+                } while (pos_ == end_ && Refill());
             }
-            return Node(std::move(dict));
-        }
 
-        Node LoadString(std::istream& input) {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true) {
-                if (it == end) {
-                    throw ParsingError("String parsing error");
-                }
-                const char ch = *it;
-                if (ch == '"') {
-                    ++it;
-                    break;
+            // Строка без экранирования возвращается ссылкой прямо в буфер, иначе собирается в scratch_.
+            // Результат действителен до следующего чтения.
+            std::string_view ParseStringValue() {
+                mark_ = pos_;
+                SkipStringRun();
+                if (pos_ != end_ && *pos_ == '"') {
+                    const std::string_view value(mark_, static_cast<size_t>(pos_ - mark_));
+                    mark_ = nullptr;
+                    ++pos_;
+                    return value;
                 }
-                else if (ch == '\\') {
-                    ++it;
-                    if (it == end) {
+                scratch_.assign(mark_, pos_);
+                mark_ = nullptr;
+
+                // Строка с экранированием — редкий случай, дальше посимвольно
+                while (true) {
+                    if (AtEnd()) {
                         throw ParsingError("String parsing error");
                     }
-                    const char escaped_char = *(it);
-                    switch (escaped_char) {
-                    case 'n':
-                        s.push_back('\n');
-                        break;
-                    case 't':
-                        s.push_back('\t');
-                        break;
-                    case 'r':
-                        s.push_back('\r');
-                        break;
-                    case '"':
-                        s.push_back('"');
+                    const char ch = *pos_++;
+                    if (ch == '"') {
                         break;
-                    case '\\':
-                        s.push_back('\\');
-                        break;
-                    default:
-                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                     }
+                    else if (ch == '\\') {
+                        if (AtEnd()) {
+                            throw ParsingError("String parsing error");
+                        }
+                        const char escaped_char = *pos_++;
+                        switch (escaped_char) {
+                        case 'n':
+                            scratch_.push_back('\n');
+                            break;
+                        case 't':
+                            scratch_.push_back('\t');
+                            break;
+                        case 'r':
+                            scratch_.push_back('\r');
+                            break;
+                        case '"':
+                            scratch_.push_back('"');
+                            break;
+                        case '\\':
+                            scratch_.push_back('\\');
+                            break;
+                        default:
+                            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                        }
+                    }
+                    else if (ch == '\n' || ch == '\r') {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
+                    else {
+                        scratch_.push_back(ch);
+                    }
+                }
+                return scratch_;
+            }
+
+            void ParseBool() {
+                const std::string_view s = ParseLiteral();
+                if (s == "true"sv) {
+                    handler_.Bool(true);
                 }
-                else if (ch == '\n' || ch == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
+                else if (s == "false"sv) {
+                    handler_.Bool(false);
                 }
                 else {
-                    s.push_back(ch);
+                    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
                 }
-                ++it;
             }
 
-            return Node(std::move(s));
-        }
-
-        Node LoadBool(std::istream& input) {
-            const auto s = LoadLiteral(input);
-            if (s == "true"sv) {
-                return Node{ true };
-            }
-            else if (s == "false"sv) {
-                return Node{ false };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+            void ParseNull() {
+                if (const std::string_view literal = ParseLiteral(); literal == "null"sv) {
+                    handler_.Null();
+                }
+                else {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
             }
-        }
 
-        Node LoadNull(std::istream& input) {
-            if (auto literal = LoadLiteral(input); literal == "null"sv) {
-                return Node{ nullptr };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+            void ReadDigits() {
+                if (!IsNext(std::isdigit)) {
+                    throw ParsingError("A digit is expected"s);
+                }
+                while (IsNext(std::isdigit)) {
+                    ++pos_;
+                }
             }
-        }
 
-        Node LoadNumber(std::istream& input) {
-            std::string parsed_num;
+            // Сначала границы числа по грамматике JSON, затем from_chars по найденному отрезку
+            void ParseNumber() {
+                mark_ = pos_;
 
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
+                if (IsNext('-')) {
+                    ++pos_;
                 }
-                };
-
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
-                    throw ParsingError("A digit is expected"s);
+                if (IsNext('0')) {
+                    ++pos_;
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                else {
+                    ReadDigits();
                 }
-                };
 
-            if (input.peek() == '-') {
-                read_char();
-            }
-            if (input.peek() == '0') {
-                read_char();
-            }
-            else {
-                read_digits();
-            }
-
-            bool is_int = true;
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
-            }
+                bool is_int = true;
+                if (IsNext('.')) {
+                    ++pos_;
+                    ReadDigits();
+                    is_int = false;
+                }
 
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+                if (IsNext('e') || IsNext('E')) {
+                    ++pos_;
+                    if (IsNext('+') || IsNext('-')) {
+                        ++pos_;
+                    }
+                    ReadDigits();
+                    is_int = false;
                 }
-                read_digits();
-                is_int = false;
-            }
 
-            try {
+                const char* begin = mark_;
+                mark_ = nullptr;
                 if (is_int) {
-                    try {
-                        return std::stoi(parsed_num);
-                    }
-                    catch (...) {
+                    int value = 0;
+                    if (const auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+                        handler_.Int(value);
+                        return;
                     }
                 }
-                return std::stod(parsed_num);
-            }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+                double value = 0;
+                if (const auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+                    handler_.Double(value);
+                    return;
+                }
+                throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
             }
-        }
 
-        Node LoadNode(std::istream& input) {
-            char c;
-            if (!(input >> c)) {
-                throw ParsingError("Unexpected EOF"s);
-            }
-            switch (c) {
-            case '[':
-                return LoadArray(input);
-            case '{':
-                return LoadDict(input);
-            case '"':
-                return LoadString(input);
-            case 't':
-                [[fallthrough]];
-            case 'f':
-                input.putback(c);
-                return LoadBool(input);
-            case 'n':
-                input.putback(c);
-                return LoadNull(input);
-            default:
-                input.putback(c);
-                return LoadNumber(input);
-            }
-        }
+            EventHandler& handler_;
+            std::istream* stream_ = nullptr;
+            std::string buffer_;
+            std::string scratch_;
+            const char* pos_ = nullptr;
+            const char* end_ = nullptr;
+            const char* mark_ = nullptr;
+        };
 
         struct PrintContext {
             std::ostream& out;
@@ -241,7 +359,7 @@ namespace json {
             ctx.out << value;
         }
 
-        void PrintString(const std::string& value, std::ostream& out) {
+        void PrintString(std::string_view value, std::ostream& out) {
             out.put('"');
             for (const char c : value) {
                 switch (c) {
@@ -268,10 +386,15 @@ namespace json {
         }
 
         template <>
-        void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
+        void PrintValue<std::pmr::string>(const std::pmr::string& value, const PrintContext& ctx) {
             PrintString(value, ctx.out);
         }
 
+        template <>
+        void PrintValue<BorrowedString>(const BorrowedString& value, const PrintContext& ctx) {
+            PrintString(value.value, ctx.out);
+        }
+
         template <>
         void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
             ctx.out << "null"sv;
@@ -334,10 +457,135 @@ namespace json {
                 node.GetValue());
         }
 
+        // Для Allocation::Heap арены нет. Первый блок арены — по размеру текста, если он известен:
+        // дерево обычно занимает того же порядка
+        std::unique_ptr<Arena> MakeArena(Allocation allocation, size_t input_size) {
+            if (allocation != Allocation::Arena) {
+                return nullptr;
+            }
+            return input_size > 0 ? std::make_unique<Arena>(input_size) : std::make_unique<Arena>();
+        }
+
     }  // namespace
 
-    Document Load(std::istream& input) {
-        return Document{ LoadNode(input) };
+    void TreeHandler::Null() {
+        AddValue(Node{ nullptr });
+    }
+
+    void TreeHandler::Bool(bool value) {
+        AddValue(Node{ value });
+    }
+
+    void TreeHandler::Int(int value) {
+        AddValue(Node{ value });
+    }
+
+    void TreeHandler::Double(double value) {
+        AddValue(Node{ value });
+    }
+
+    void TreeHandler::String(std::string_view value) {
+        // Без escape-последовательностей парсер отдаёт строку прямо из входного буфера
+        const std::less<const char*> less;
+        const bool in_pinned = !pinned_.empty() && !less(value.data(), pinned_.data())
+            && !less(pinned_.data() + pinned_.size(), value.data() + value.size());
+        if (in_pinned) {
+            AddValue(Node{ BorrowedString{ value } });
+        }
+        else {
+            AddValue(Node{ std::pmr::string(value, resource_) });
+        }
+    }
+
+    void TreeHandler::StartArray() {
+        stack_.emplace_back(Array(resource_));
+    }
+
+    void TreeHandler::EndArray() {
+        Node array = std::move(stack_.back());
+        stack_.pop_back();
+        AddValue(std::move(array));
+    }
+
+    void TreeHandler::StartDict() {
+        stack_.emplace_back(Dict(resource_));
+    }
+
+    void TreeHandler::Key(std::string_view key) {
+        const Dict& dict = std::get<Dict>(stack_.back().GetValue());
+        if (dict.find(key) != dict.end()) {
+            throw ParsingError("Duplicate key '"s + std::string(key) + "' have been found");
+        }
+        keys_.emplace_back(key, resource_);
+    }
+
+    void TreeHandler::EndDict() {
+        Node dict = std::move(stack_.back());
+        stack_.pop_back();
+        AddValue(std::move(dict));
+    }
+
+    Node TreeHandler::TakeRoot() {
+        return std::exchange(root_, Node{});
+    }
+
+    void TreeHandler::AddValue(Node value) {
+        if (stack_.empty()) {
+            root_ = std::move(value);
+            return;
+        }
+        Node::Value& parent = stack_.back().GetValue();
+        if (auto* array = std::get_if<Array>(&parent)) {
+            array->push_back(std::move(value));
+        }
+        else {
+            std::get<Dict>(parent).emplace(std::move(keys_.back()), std::move(value));
+            keys_.pop_back();
+        }
+    }
+
+    void Parse(std::string_view input, Handler& handler) {
+        Parser<Handler>(input, handler).ParseNode();
+    }
+
+    void Parse(std::istream& input, Handler& handler) {
+        Parser<Handler>(input, handler).ParseNode();
+    }
+
+    Document::Document(Node root)
+        : Document(std::move(root), nullptr) {
+    }
+
+    Document::Document(Node root, std::unique_ptr<Arena> arena) {
+        if (!arena) {
+            root_ = std::make_shared<const Node>(std::move(root));
+            return;
+        }
+        // Корень тоже кладётся в арену, а shared_ptr владеет только ею
+        const std::shared_ptr<Arena> owner(std::move(arena));
+        void* place = owner->allocate(sizeof(Node), alignof(Node));
+        root_ = std::shared_ptr<const Node>(owner, new (place) Node(std::move(root)));
+    }
+
+    Document Load(std::istream& input, Allocation allocation) {
+        auto arena = MakeArena(allocation, 0);
+        TreeHandler handler(arena ? arena.get() : std::pmr::get_default_resource());
+        Parser<TreeHandler>(input, handler).ParseNode();
+        return Document{ handler.TakeRoot(), std::move(arena) };
+    }
+
+    Document Load(std::string_view input, Allocation allocation) {
+        auto arena = MakeArena(allocation, input.size());
+        TreeHandler handler(arena ? arena.get() : std::pmr::get_default_resource());
+        Parser<TreeHandler>(input, handler).ParseNode();
+        return Document{ handler.TakeRoot(), std::move(arena) };
+    }
+
+    Document LoadInPlace(std::string_view input, Allocation allocation) {
+        auto arena = MakeArena(allocation, input.size());
+        TreeHandler handler(arena ? arena.get() : std::pmr::get_default_resource(), input);
+        Parser<TreeHandler>(input, handler).ParseNode();
+        return Document{ handler.TakeRoot(), std::move(arena) };
     }
 
     void Print(const Document& doc, std::ostream& output) {
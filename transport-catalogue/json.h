@@ -2,28 +2,53 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace json {
 
+    // Контейнеры и строки узлов берут память из memory_resource, переданного при создании;
+    // по умолчанию это обычная куча. Копия узла всегда выделяется из кучи
     class Node;
-    using Dict = std::map<std::string, Node>;
-    using Array = std::vector<Node>;
+    using Dict = std::pmr::map<std::pmr::string, Node, std::less<>>;
+    using Array = std::pmr::vector<Node>;
+
+    // Арена документа: память только выделяется и освобождается разом вместе с документом
+    using Arena = std::pmr::monotonic_buffer_resource;
+
+    enum class Allocation {
+        // Каждый контейнер и строка — отдельное выделение из кучи
+        Heap,
+        // Все узлы в арене, которой владеет Document
+        Arena,
+    };
 
     class ParsingError : public std::runtime_error {
     public:
         using runtime_error::runtime_error;
     };
 
+    // Строка, не владеющая символами: указывает в буфер, разобранный LoadInPlace
+    struct BorrowedString {
+        std::string_view value;
+    };
+
+    inline bool operator==(const BorrowedString& lhs, const BorrowedString& rhs) {
+        return lhs.value == rhs.value;
+    }
+
     class Node final
-        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::pmr::string, BorrowedString> {
     public:
         using variant::variant;
         using Value = variant;
 
         Node(Value value) : variant(std::move(value)) {}
+        Node(const std::string& value) : variant(std::pmr::string(value)) {}
 
         bool IsInt() const {
             return std::holds_alternative<int>(*this);
@@ -79,15 +104,19 @@ namespace json {
         }
 
         bool IsString() const {
-            return std::holds_alternative<std::string>(*this);
+            return std::holds_alternative<std::pmr::string>(*this) || std::holds_alternative<BorrowedString>(*this);
         }
-        const std::string& AsString() const {
+        // Строка действительна, пока жив узел, а для узлов из LoadInPlace — ещё и разобранный буфер
+        std::string_view AsString() const {
             using namespace std::literals;
+            if (const auto* borrowed = std::get_if<BorrowedString>(this)) {
+                return borrowed->value;
+            }
             if (!IsString()) {
                 throw std::logic_error("Not a string"s);
             }
 
-            return std::get<std::string>(*this);
+            return std::get<std::pmr::string>(*this);
         }
 
         bool IsDict() const {
@@ -102,7 +131,11 @@ namespace json {
             return std::get<Dict>(*this);
         }
 
+        // Своя и заимствованная строки равны, если совпадают символы
         bool operator==(const Node& rhs) const {
+            if (IsString() && rhs.IsString()) {
+                return AsString() == rhs.AsString();
+            }
             return GetValue() == rhs.GetValue();
         }
 
@@ -118,18 +151,29 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    class Builder;
+
+    // Неизменяемый документ; копии разделяют одно дерево
     class Document {
     public:
-        explicit Document(Node root)
-            : root_(std::move(root)) {
-        }
+        explicit Document(Node root);
 
         const Node& GetRoot() const {
-            return root_;
+            return *root_;
         }
 
     private:
-        Node root_;
+        // Все узлы root должны быть выделены из arena: их деструкторы не вызываются, документ,
+        // как и его последняя копия, освобождает арену целиком, не обходя дерево. Узел из кучи
+        // здесь утёк бы, поэтому конструктор доступен только загрузчикам и Builder
+        Document(Node root, std::unique_ptr<Arena> arena);
+
+        friend Document Load(std::istream& input, Allocation allocation);
+        friend Document Load(std::string_view input, Allocation allocation);
+        friend Document LoadInPlace(std::string_view input, Allocation allocation);
+        friend class Builder;
+
+        std::shared_ptr<const Node> root_;
     };
 
     inline bool operator==(const Document& lhs, const Document& rhs) {
@@ -140,7 +184,72 @@ namespace json {
         return !(lhs == rhs);
     }
 
-    Document Load(std::istream& input);
+    // Обработчик событий разбора (SAX): Parse вызывает его по мере чтения документа, не строя дерево.
+    // Строки и ключи передаются string_view, действительными только на время вызова.
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        virtual void Null() = 0;
+        virtual void Bool(bool value) = 0;
+        virtual void Int(int value) = 0;
+        virtual void Double(double value) = 0;
+        virtual void String(std::string_view value) = 0;
+        virtual void StartArray() = 0;
+        virtual void EndArray() = 0;
+        virtual void StartDict() = 0;
+        virtual void Key(std::string_view key) = 0;
+        virtual void EndDict() = 0;
+    };
+
+    // Собирает из событий дерево узлов; на нём построен Load.
+    // Повторный ключ в словаре — ParsingError.
+    class TreeHandler final : public Handler {
+    public:
+        // Контейнеры и строки узлов выделяются из resource. Строки, лежащие внутри pinned,
+        // не копируются, а становятся BorrowedString
+        explicit TreeHandler(std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                             std::string_view pinned = {})
+            : resource_(resource)
+            , pinned_(pinned) {
+        }
+
+        void Null() override;
+        void Bool(bool value) override;
+        void Int(int value) override;
+        void Double(double value) override;
+        void String(std::string_view value) override;
+        void StartArray() override;
+        void EndArray() override;
+        void StartDict() override;
+        void Key(std::string_view key) override;
+        void EndDict() override;
+
+        Node TakeRoot();
+
+    private:
+        void AddValue(Node value);
+
+        // Открытые массивы и словари и ключи, ждущие значения
+        std::vector<Node> stack_;
+        std::vector<std::pmr::string> keys_;
+        Node root_;
+        std::pmr::memory_resource* resource_;
+        std::string_view pinned_;
+    };
+
+    // Разбирает один документ, сообщая события handler. Из потока читает кусками,
+    // держа в памяти только текущий кусок и недочитанную лексему.
+    void Parse(std::string_view input, Handler& handler);
+    void Parse(std::istream& input, Handler& handler);
+
+    Document Load(std::istream& input, Allocation allocation = Allocation::Heap);
+    // Разбирает непрерывный буфер, например строку или отображённый файл
+    Document Load(std::string_view input, Allocation allocation = Allocation::Heap);
+    // Как Load(std::string_view), но строки без escape-последовательностей не копируются,
+    // а ссылаются в input; строки с ними и ключи словарей хранятся в узлах.
+    // Буфер должен жить и не меняться, пока используется документ
+    Document LoadInPlace(std::string_view input, Allocation allocation = Allocation::Heap);
 
     void Print(const Document& doc, std::ostream& output);
 
@@ -1,5 +1,6 @@
 #include "json_builder.h"
 #include <exception>
+#include <type_traits>
 #include <variant>
 #include <utility>
 
@@ -7,18 +8,60 @@ using namespace std::literals;
 
 namespace json {
 
-    Builder::Builder()
-        : root_()
+    namespace {
+
+        // Глубокая копия узла, все контейнеры и строки которой выделены из resource
+        Node CopyNode(const Node& node, std::pmr::memory_resource* resource) {
+            return std::visit(
+                [resource](const auto& value) -> Node {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<T, Array>) {
+                        Array array(resource);
+                        array.reserve(value.size());
+                        for (const Node& item : value) {
+                            array.push_back(CopyNode(item, resource));
+                        }
+                        return Node{ std::move(array) };
+                    }
+                    else if constexpr (std::is_same_v<T, Dict>) {
+                        Dict dict(resource);
+                        for (const auto& [key, item] : value) {
+                            dict.emplace(key, CopyNode(item, resource));
+                        }
+                        return Node{ std::move(dict) };
+                    }
+                    else if constexpr (std::is_same_v<T, std::pmr::string>) {
+                        return Node{ std::pmr::string(value, resource) };
+                    }
+                    else {
+                        return Node{ value };
+                    }
+                },
+                node.GetValue());
+        }
+
+    }  // namespace
+
+    Builder::Builder(Allocation allocation)
+        : arena_(allocation == Allocation::Arena ? std::make_unique<Arena>() : nullptr)
+        , resource_(arena_ ? arena_.get() : std::pmr::get_default_resource())
+        , root_()
         , nodes_stack_{ &root_ }
     {}
 
     Node Builder::Build() {
-        if (!nodes_stack_.empty()) {
-            throw std::logic_error("JSON object is not fully constructed");
+        AssertBuilt();
+        if (arena_) {
+            throw std::logic_error("Arena-backed JSON must be taken with BuildDocument()"s);
         }
         return std::move(root_);
     }
 
+    Document Builder::BuildDocument() {
+        AssertBuilt();
+        return Document{ std::move(root_), std::move(arena_) };
+    }
+
     Builder::DictValueContext Builder::Key(std::string key) {
         Node::Value& host_value = GetCurrentValue();
 
@@ -27,18 +70,21 @@ namespace json {
         }
 
         nodes_stack_.push_back(
-            &std::get<Dict>(host_value)[std::move(key)]
+            &std::get<Dict>(host_value)[std::pmr::string(key, resource_)]
         );
         return BaseContext{ *this };
     }
 
-    Builder::BaseContext Builder::Value(Node::Value value) {
-        AddObject(std::move(value), true);
+    Builder::BaseContext Builder::Value(Node value) {
+        // Значение, собранное вне арены, копируется в неё: арена освобождается без деструкторов.
+        // Присваивать нельзя: pmr-контейнер при присваивании не меняет свой ресурс
+        Node stored = arena_ ? CopyNode(value, resource_) : std::move(value);
+        AddObject(std::move(stored.GetValue()), true);
         return *this;
     }
 
     Builder::DictItemContext Builder::StartDict() {
-        AddObject(Dict{}, false);
+        AddObject(Dict(resource_), false);
         return BaseContext{ *this };
     }
 
@@ -51,7 +97,7 @@ namespace json {
     }
 
     Builder::ArrayItemContext Builder::StartArray() {
-        AddObject(Array{}, false);
+        AddObject(Array(resource_), false);
         return ArrayItemContext{ *this };
     }
 
@@ -74,6 +120,12 @@ namespace json {
         return const_cast<Builder*>(this)->GetCurrentValue();
     }
 
+    void Builder::AssertBuilt() const {
+        if (!nodes_stack_.empty()) {
+            throw std::logic_error("JSON object is not fully constructed");
+        }
+    }
+
     void Builder::AssertNewObjectContext() const {
         if (!std::holds_alternative<std::nullptr_t>(GetCurrentValue())) {
             throw std::logic_error("New object in wrong context"s);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "json.h"
@@ -14,22 +15,27 @@ namespace json {
         class ArrayItemContext;
 
     public:
-        Builder();
+        // С Allocation::Arena все узлы строятся в арене, и результат забирается только BuildDocument
+        explicit Builder(Allocation allocation = Allocation::Heap);
         Node Build();
+        Document BuildDocument();
         DictValueContext Key(std::string key);
-        BaseContext Value(Node::Value value);
+        BaseContext Value(Node value);
         DictItemContext StartDict();
         ArrayItemContext StartArray();
         BaseContext EndDict();
         BaseContext EndArray();
 
     private:
+        std::unique_ptr<Arena> arena_;
+        std::pmr::memory_resource* resource_;
         Node root_;
         std::vector<Node*> nodes_stack_;
 
         Node::Value& GetCurrentValue();
         const Node::Value& GetCurrentValue() const;
 
+        void AssertBuilt() const;
         void AssertNewObjectContext() const;
         void AddObject(Node::Value value, bool one_shot);
 
@@ -39,10 +45,13 @@ namespace json {
             Node Build() {
                 return builder_.Build();
             }
+            Document BuildDocument() {
+                return builder_.BuildDocument();
+            }
             DictValueContext Key(std::string key) {
                 return builder_.Key(std::move(key));
             }
-            BaseContext Value(Node::Value value) {
+            BaseContext Value(Node value) {
                 return builder_.Value(std::move(value));
             }
             DictItemContext StartDict() {
@@ -64,8 +73,9 @@ namespace json {
         class DictValueContext : public BaseContext {
         public:
             DictValueContext(BaseContext base) : BaseContext(base) {}
-            DictItemContext Value(Node::Value value) { return BaseContext::Value(std::move(value)); }
+            DictItemContext Value(Node value) { return BaseContext::Value(std::move(value)); }
             Node Build() = delete;
+            Document BuildDocument() = delete;
             DictValueContext Key(std::string key) = delete;
             BaseContext EndDict() = delete;
             BaseContext EndArray() = delete;
@@ -75,7 +85,8 @@ namespace json {
         public:
             DictItemContext(BaseContext base) : BaseContext(base) {}
             Node Build() = delete;
-            BaseContext Value(Node::Value value) = delete;
+            Document BuildDocument() = delete;
+            BaseContext Value(Node value) = delete;
             BaseContext EndArray() = delete;
             DictItemContext StartDict() = delete;
             ArrayItemContext StartArray() = delete;
@@ -84,8 +95,9 @@ namespace json {
         class ArrayItemContext : public BaseContext {
         public:
             ArrayItemContext(BaseContext base) : BaseContext(base) {}
-            ArrayItemContext Value(Node::Value value) { return BaseContext::Value(std::move(value)); }
+            ArrayItemContext Value(Node value) { return BaseContext::Value(std::move(value)); }
             Node Build() = delete;
+            Document BuildDocument() = delete;
             DictValueContext Key(std::string key) = delete;
             BaseContext EndDict() = delete;
         };
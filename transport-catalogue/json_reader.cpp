@@ -1,8 +1,13 @@
 #include "json_reader.h"
+#include "catalogue_builder.h"
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "json_builder.h"
+#include "streaming_loader.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
@@ -42,14 +47,14 @@ namespace json_reader {
             }
         }
         else {
-            settings.underlayer_color = underlayer_color.AsString();
+            settings.underlayer_color = std::string(underlayer_color.AsString());
         }
         settings.underlayer_width = dict.at("underlayer_width").AsDouble();
 
         const auto& color_palette = dict.at("color_palette").AsArray();
         for (const auto& color_node : color_palette) {
             if (color_node.IsString()) {
-                settings.color_palette.emplace_back(color_node.AsString());
+                settings.color_palette.emplace_back(std::string(color_node.AsString()));
             }
             else if (color_node.IsArray()) {
                 const auto& color_array = color_node.AsArray();
@@ -79,69 +84,117 @@ namespace json_reader {
         settings.bus_wait_time = std::chrono::minutes(dict.at("bus_wait_time").AsInt());
         settings.bus_velocity = dict.at("bus_velocity").AsDouble();
 
+        if (const auto it = dict.find("router_engine"); it != dict.end()) {
+            const std::string_view engine = it->second.AsString();
+            if (engine == "all_pairs") {
+                settings.engine = router::RouterEngine::AllPairs;
+            }
+            else if (engine == "all_pairs_flat") {
+                settings.engine = router::RouterEngine::AllPairsFlat;
+            }
+            else if (engine == "dijkstra") {
+                settings.engine = router::RouterEngine::Dijkstra;
+            }
+            else if (engine == "contraction_hierarchies") {
+                settings.engine = router::RouterEngine::ContractionHierarchies;
+            }
+            else if (engine == "raptor") {
+                settings.engine = router::RouterEngine::Raptor;
+            }
+            else if (engine == "a_star") {
+                settings.engine = router::RouterEngine::AStar;
+            }
+            else if (engine == "bidirectional_dijkstra") {
+                settings.engine = router::RouterEngine::BidirectionalDijkstra;
+            }
+            else {
+                throw std::invalid_argument("Unknown router engine: " + std::string(engine));
+            }
+        }
+
+        if (const auto it = dict.find("router_threads"); it != dict.end()) {
+            const int thread_count = it->second.AsInt();
+            settings.thread_count = thread_count > 0
+                ? static_cast<size_t>(thread_count)
+                : thread_pool::ThreadPool::GetDefaultThreadCount();
+        }
+
         return settings;
     }
 
-    json::Node JsonReader::ProcessRequests(const json::Node& input) {
-        const auto& root = input.AsDict();
+    // FNV-1a от канонической печати узла, продолжающий хеш seed: снимок маршрутизатора
+    // считается от суммы каталога и routing_settings и устаревает при любом их изменении
+    uint64_t JsonReader::ComputeChecksum(const json::Node& node, uint64_t seed) {
+        std::ostringstream output;
+        json::Print(json::Document{ node }, output);
+
+        uint64_t hash = seed;
+        for (const char c : output.str()) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    json::Node JsonReader::ProcessRequests(std::istream& input) {
+        StreamingLoader loader;
+        json::Parse(input, loader);
+        if (loader.HasBaseRequests()) {
+            BuildCatalogue(loader);
+        }
+        const json::Dict root = loader.TakeRoot();
 
-        ProcessBaseRequests(root.at("base_requests").AsArray());
         render_settings_ = ParseRenderSettings(root.at("render_settings").AsDict());
         routing_settings_ = ParseRoutingSettings(root.at("routing_settings").AsDict());
 
         if (!transport_router_) {
-            transport_router_ = std::make_unique<router::TransportRouter>(tc_, routing_settings_);
+            if (const auto it = root.find("serialization_settings"); it != root.end()) {
+                const std::string file(it->second.AsDict().at("file").AsString());
+                const uint64_t checksum = ComputeChecksum(root.at("routing_settings"), base_checksum_);
+                transport_router_ = router::TransportRouter::LoadSnapshot(tc_, routing_settings_, file, checksum);
+                if (!transport_router_) {
+                    transport_router_ = std::make_unique<router::TransportRouter>(tc_, routing_settings_);
+                    // Снимок — только кэш: если записать его не вышло, запросы обслуживает построенный маршрутизатор
+                    try {
+                        transport_router_->SaveSnapshot(file, checksum);
+                    }
+                    catch (const std::runtime_error& error) {
+                        std::cerr << "Warning: " << error.what() << std::endl;
+                    }
+                }
+            }
+            else {
+                transport_router_ = std::make_unique<router::TransportRouter>(tc_, routing_settings_);
+            }
         }
 
         return json::Node{ ProcessStatRequests(root.at("stat_requests").AsArray()) };
     }
 
-    void JsonReader::ProcessBaseRequests(const json::Array& base_requests) {
-        std::unordered_set<std::string> stops_in_routes;
-
-        for (const auto& request : base_requests) {
-            const auto& request_map = request.AsDict();
-            const std::string& type = request_map.at("type").AsString();
-            if (type == "Stop") {
-                const std::string& name = request_map.at("name").AsString();
-                const double latitude = request_map.at("latitude").AsDouble();
-                const double longitude = request_map.at("longitude").AsDouble();
-
-                domain::Stop stop{ name, {latitude, longitude} };
-                tc_.AddStop(stop);
-            }
+    void JsonReader::SaveCatalogueSnapshot(std::istream& input, const std::string& path) {
+        StreamingLoader loader;
+        json::Parse(input, loader);
+        if (!loader.HasBaseRequests()) {
+            throw std::out_of_range("No base_requests in input");
         }
+        BuildCatalogue(loader);
+        tc_.SaveSnapshot(path, base_checksum_);
+    }
 
-        for (const auto& request : base_requests) {
-            const auto& request_map = request.AsDict();
-            const std::string& type = request_map.at("type").AsString();
-            if (type == "Bus") {
-                const std::string& name = request_map.at("name").AsString();
-                const auto& stops_node = request_map.at("stops").AsArray();
-                std::vector<std::string_view> stops;
-                for (const auto& stop_node : stops_node) {
-                    stops.emplace_back(stop_node.AsString());
-                    stops_in_routes.insert(stop_node.AsString());
-                }
-                const bool is_roundtrip = request_map.at("is_roundtrip").AsBool();
-
-                domain::Bus bus{ name, stops, is_roundtrip };
-                tc_.AddBus(bus);
-            }
+    void JsonReader::LoadCatalogueSnapshot(const std::string& path) {
+        auto tc = transport_catalogue::TransportCatalogue::LoadSnapshot(path);
+        if (!tc) {
+            throw std::runtime_error("Cannot load catalogue snapshot: " + path);
         }
+        transport_router_.reset();
+        tc_ = std::move(*tc);
+        base_checksum_ = *tc_.GetSourceChecksum();
+    }
 
-        for (const auto& request : base_requests) {
-            const auto& request_map = request.AsDict();
-            const std::string& type = request_map.at("type").AsString();
-            if (type == "Stop") {
-                const std::string& name = request_map.at("name").AsString();
-                const auto& road_distances = request_map.at("road_distances").AsDict();
-                for (const auto& [neighbor_name, distance_node] : road_distances) {
-                    tc_.SetDistance(name, neighbor_name, distance_node.AsInt());
-                }
-            }
-        }
-        tc_.UpdateFilteredStops(stops_in_routes);
+    void JsonReader::BuildCatalogue(const StreamingLoader& loader) {
+        transport_router_.reset();
+        tc_ = loader.GetBuilder().Build(thread_pool::ThreadPool::GetDefaultThreadCount());
+        base_checksum_ = loader.GetBaseChecksum();
     }
 
     json::Array JsonReader::ProcessStatRequests(const json::Array& stat_requests) {
@@ -151,30 +204,29 @@ namespace json_reader {
         for (const auto& request : stat_requests) {
             const auto& request_map = request.AsDict();
             const int request_id = request_map.at("id").AsInt();
-            const std::string& type = request_map.at("type").AsString();
+            const std::string_view type = request_map.at("type").AsString();
 
             json::Builder response_builder;
             response_builder.StartDict().Key("request_id").Value(request_id);
 
             if (type == "Stop") {
-                const std::string& name = request_map.at("name").AsString();
+                const std::string_view name = request_map.at("name").AsString();
                 auto buses_opt = handler.GetBusesByStop(name);
                 if (!buses_opt) {
                     response_builder.Key("error_message").Value("not found");
                 }
                 else {
-                    const auto& buses = *buses_opt;
                     json::Array buses_node;
-                    for (const auto& bus : buses) {
-                        buses_node.push_back(bus.name);
+                    for (const domain::BusId bus : *buses_opt) {
+                        buses_node.push_back(std::string(handler.GetBusName(bus)));
                     }
                     response_builder.Key("buses").Value(buses_node);
                 }
             }
             else if (type == "Bus") {
-                const std::string& name = request_map.at("name").AsString();
+                const std::string_view name = request_map.at("name").AsString();
                 try {
-                    domain::BusInfo bus_info = handler.GetBusInfo(name);
+                    const domain::BusInfo& bus_info = handler.GetBusInfo(name);
                     response_builder.Key("curvature").Value(bus_info.curvature)
                         .Key("route_length").Value(static_cast<int>(bus_info.len))
                         .Key("stop_count").Value(static_cast<int>(bus_info.count_stops))
@@ -191,17 +243,17 @@ namespace json_reader {
                 response_builder.Key("map").Value(map_svg);
             }
             else if (type == "Route") {
-                const std::string& from = request_map.at("from").AsString();
-                const std::string& to = request_map.at("to").AsString();
+                const std::string_view from = request_map.at("from").AsString();
+                const std::string_view to = request_map.at("to").AsString();
 
-                const auto from_stop = tc_.FindStop(from);
-                const auto to_stop = tc_.FindStop(to);
+                const auto from_stop = tc_.FindStopId(from);
+                const auto to_stop = tc_.FindStopId(to);
 
                 if (!from_stop || !to_stop) {
                     response_builder.Key("error_message").Value(std::string("not found"));
                 }
                 else {
-                    auto route_info = transport_router_->FindOptimalRoute(from, to);
+                    auto route_info = transport_router_->FindOptimalRoute(*from_stop, *to_stop);
                     if (route_info) {
                         response_builder.Key("total_time").Value(route_info->total_time);
                         json::Array items;
@@ -231,12 +283,64 @@ namespace json_reader {
                             }
                         }
                         response_builder.Key("items").Value(items);
+                        if (route_info->settled_vertices) {
+                            response_builder.Key("settled_vertices")
+                                .Value(static_cast<int>(*route_info->settled_vertices));
+                        }
                     }
                     else {
                         response_builder.Key("error_message").Value(std::string("not found"));
                     }
                 }
             }
+            else if (type == "NearbyStops") {
+                const geo::Coordinates center{ request_map.at("latitude").AsDouble(),
+                                               request_map.at("longitude").AsDouble() };
+                // Без count — все остановки в радиусе, без radius — count ближайших
+                size_t count = std::numeric_limits<size_t>::max();
+                if (const auto it = request_map.find("count"); it != request_map.end()) {
+                    count = static_cast<size_t>(std::max(0, it->second.AsInt()));
+                }
+                double radius = std::numeric_limits<double>::infinity();
+                if (const auto it = request_map.find("radius"); it != request_map.end()) {
+                    radius = it->second.AsDouble();
+                }
+
+                json::Array stops;
+                for (const auto& neighbor : tc_.FindNearestStops(center, count, radius)) {
+                    stops.push_back(
+                        json::Builder{}
+                        .StartDict()
+                        .Key("name").Value(std::string(tc_.GetStopName(neighbor.stop)))
+                        .Key("distance").Value(neighbor.distance)
+                        .EndDict()
+                        .Build()
+                    );
+                }
+                response_builder.Key("stops").Value(stops);
+            }
+            else if (type == "StopsInBox") {
+                const geo::Coordinates min{ request_map.at("min_latitude").AsDouble(),
+                                            request_map.at("min_longitude").AsDouble() };
+                const geo::Coordinates max{ request_map.at("max_latitude").AsDouble(),
+                                            request_map.at("max_longitude").AsDouble() };
+
+                std::vector<domain::StopId> stop_ids = tc_.FindStopsInBox(min, max);
+                std::sort(stop_ids.begin(), stop_ids.end(), [this](domain::StopId lhs, domain::StopId rhs) {
+                    return tc_.GetStopName(lhs) < tc_.GetStopName(rhs);
+                });
+                json::Array stops;
+                for (const domain::StopId stop : stop_ids) {
+                    stops.push_back(std::string(tc_.GetStopName(stop)));
+                }
+                response_builder.Key("stops").Value(stops);
+            }
+            else if (type == "Stats") {
+                // Служебные сведения о каталоге: размеры и время финализации в микросекундах
+                response_builder.Key("stop_count").Value(static_cast<int>(tc_.GetStopCount()))
+                    .Key("bus_count").Value(static_cast<int>(tc_.GetBusCount()))
+                    .Key("finalization_time_us").Value(static_cast<int>(tc_.GetFinalizationTime().count()));
+            }
 
             responses.push_back(response_builder.EndDict().Build());
         }
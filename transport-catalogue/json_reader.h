@@ -5,6 +5,9 @@
 #include "svg.h"
 #include "transport_router.h"
 #include "router.h"
+#include <cstdint>
+#include <istream>
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -25,22 +28,35 @@ namespace json_reader {
         std::vector<svg::Color> color_palette;
     };
 
+    class StreamingLoader;
+
     class JsonReader {
     public:
         JsonReader(transport_catalogue::TransportCatalogue& tc)
             : tc_(tc), transport_router_(nullptr) {}
 
-        json::Node ProcessRequests(const json::Node& input);
+        // Читает запрос из потока: base_requests сразу идут в построитель каталога, в дерево
+        // собираются только остальные ключи. Без base_requests во входе запросы выполняются
+        // над каталогом из LoadCatalogueSnapshot
+        json::Node ProcessRequests(std::istream& input);
+
+        // Строит каталог по base_requests из input и сохраняет его снимок в path
+        void SaveCatalogueSnapshot(std::istream& input, const std::string& path);
+        // Загружает каталог из снимка; если файла нет или он повреждён, бросает std::runtime_error
+        void LoadCatalogueSnapshot(const std::string& path);
 
     private:
         RenderSettings ParseRenderSettings(const json::Dict& dict);
         router::RoutingSettings ParseRoutingSettings(const json::Dict& dict);
-        void ProcessBaseRequests(const json::Array& base_requests);
+        static uint64_t ComputeChecksum(const json::Node& node, uint64_t seed);
+        void BuildCatalogue(const StreamingLoader& loader);
         json::Array ProcessStatRequests(const json::Array& stat_requests);
 
         transport_catalogue::TransportCatalogue& tc_;
         RenderSettings render_settings_;
         router::RoutingSettings routing_settings_;
+        // Контрольная сумма base_requests, из которых построен каталог
+        uint64_t base_checksum_ = 0;
         std::unique_ptr<router::TransportRouter> transport_router_;
     };
 
@@ -2,16 +2,45 @@
 #include "transport_catalogue.h" 
 #include "json.h" 
 #include <iostream> 
+#include <string_view>
+
+using namespace std::literals;
+
+namespace {
+
+    void PrintUsage(std::ostream& stream = std::cerr) {
+        stream << "Usage: transport_catalogue [make_base|process_requests <snapshot>]\n"sv;
+    }
+
+}  // namespace
+
+// Без аргументов читает полный запрос из stdin. make_base сохраняет каталог из base_requests
+// в снимок, process_requests берёт каталог из снимка вместо base_requests.
+int main(int argc, char* argv[]) {
+    if (argc != 1 && argc != 3) {
+        PrintUsage();
+        return 1;
+    }
 
-int main() {
     transport_catalogue::TransportCatalogue tc;
     json_reader::JsonReader reader(tc);
 
-    json::Document input_doc = json::Load(std::cin);
+    if (argc == 3) {
+        const std::string_view mode(argv[1]);
+        if (mode == "make_base"sv) {
+            reader.SaveCatalogueSnapshot(std::cin, argv[2]);
+            return 0;
+        }
+        if (mode != "process_requests"sv) {
+            PrintUsage();
+            return 1;
+        }
+        reader.LoadCatalogueSnapshot(argv[2]);
+    }
 
-    json::Node output = reader.ProcessRequests(input_doc.GetRoot());
+    json::Node output = reader.ProcessRequests(std::cin);
 
     json::Print(json::Document{ output }, std::cout);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -5,26 +5,27 @@ namespace map_renderer {
 
     void RenderMap(const transport_catalogue::TransportCatalogue& tc, std::ostream& output, const json_reader::RenderSettings& settings) {
         std::vector<geo::Coordinates> coordinates;
-        for (const auto& [name, stop] : tc.GetStops()) {
-            if (!tc.GetBusesByStop(name).has_value()) continue;
-            coordinates.emplace_back(stop.coordinates);
+        for (const domain::StopId stop : tc.GetServedStops()) {
+            coordinates.emplace_back(tc.GetStopCoordinates(stop));
         }
 
         SphereProjector projector(coordinates.begin(), coordinates.end(), settings.width, settings.height, settings.padding);
 
         svg::Document doc;
 
-        std::vector<std::string> bus_names;
-        for (const auto& [name, bus] : tc.GetBuses()) {
-            bus_names.emplace_back(name);
+        std::vector<domain::BusId> buses(tc.GetBusCount());
+        for (domain::BusId bus = 0; bus < buses.size(); ++bus) {
+            buses[bus] = bus;
         }
-        std::sort(bus_names.begin(), bus_names.end());
+        std::sort(buses.begin(), buses.end(), [&tc](domain::BusId lhs, domain::BusId rhs) {
+            return tc.GetBusName(lhs) < tc.GetBusName(rhs);
+        });
 
         size_t color_index = 0;
 
-        for (const auto& name : bus_names) {
-            const auto& bus = tc.GetBuses().at(name);
-            if (bus.stops.empty()) continue;
+        for (const domain::BusId bus : buses) {
+            const auto stops = tc.GetBusStops(bus);
+            if (stops.empty()) continue;
 
             svg::Polyline polyline;
             const auto& color = settings.color_palette[color_index % settings.color_palette.size()];
@@ -34,17 +35,15 @@ namespace map_renderer {
                 .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                 .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-            for (const auto& stop_name : bus.stops) {
-                const auto& stop = tc.GetStops().at(std::string(stop_name));
-                auto point = projector(stop.coordinates);
+            for (const domain::StopId stop : stops) {
+                auto point = projector(tc.GetStopCoordinates(stop));
                 polyline.AddPoint(point);
             }
 
-            if (!bus.is_circular) {
-                for (auto it = std::next(bus.stops.rbegin()); it != bus.stops.rend(); ++it) {
-                    const auto& stop = tc.GetStops().at(std::string(*it));
-                    auto point = projector(stop.coordinates);
-                   polyline.AddPoint(point);
+            if (!tc.IsBusCircular(bus)) {
+                for (const domain::StopId* it = stops.end() - 1; it != stops.begin(); --it) {
+                    auto point = projector(tc.GetStopCoordinates(*(it - 1)));
+                    polyline.AddPoint(point);
                 }
             }
 
@@ -53,13 +52,14 @@ namespace map_renderer {
         }
 
         color_index = 0;
-        for (const auto& name : bus_names) {
-            const auto& bus = tc.GetBuses().at(name);
-            if (bus.stops.empty()) continue;
+        for (const domain::BusId bus : buses) {
+            const auto stops = tc.GetBusStops(bus);
+            if (stops.empty()) continue;
 
             const auto& color = settings.color_palette[color_index % settings.color_palette.size()];
-            const auto& first_stop = tc.GetStops().at(std::string(bus.stops.front())).coordinates;
-            const auto& last_stop = tc.GetStops().at(std::string(bus.stops.back())).coordinates;
+            const domain::StopId first_stop = *stops.begin();
+            const domain::StopId last_stop = *(stops.end() - 1);
+            const std::string bus_name(tc.GetBusName(bus));
 
             auto draw_text = [&](const geo::Coordinates& coords, const std::string& label) {
                 svg::Text text_underlayer;
@@ -88,24 +88,22 @@ namespace map_renderer {
                 doc.Add(std::move(text));
                 };
 
-            draw_text(first_stop, bus.name);
-            if (!bus.is_circular && bus.stops.front() != bus.stops.back()) {
-                draw_text(last_stop, bus.name);
+            draw_text(tc.GetStopCoordinates(first_stop), bus_name);
+            if (!tc.IsBusCircular(bus) && first_stop != last_stop) {
+                draw_text(tc.GetStopCoordinates(last_stop), bus_name);
             }
 
             ++color_index;
         }
 
-        std::vector<std::string> stop_names;
-        for (const auto& [name, stop] : tc.GetStops()) {
-            if (tc.GetBusesByStop(name).has_value()) {
-                stop_names.push_back(name);
-            }
-        }
-        std::sort(stop_names.begin(), stop_names.end());
+        const auto served_stops = tc.GetServedStops();
+        std::vector<domain::StopId> stops(served_stops.begin(), served_stops.end());
+        std::sort(stops.begin(), stops.end(), [&tc](domain::StopId lhs, domain::StopId rhs) {
+            return tc.GetStopName(lhs) < tc.GetStopName(rhs);
+        });
 
-        for (const auto& name : stop_names) {
-            const auto& stop = tc.GetStops().at(name).coordinates;
+        for (const domain::StopId stop_id : stops) {
+            const auto& stop = tc.GetStopCoordinates(stop_id);
             svg::Circle circle;
             circle.SetCenter(projector(stop))
                 .SetRadius(settings.stop_radius)
@@ -114,8 +112,9 @@ namespace map_renderer {
             doc.Add(std::move(circle));
         }
 
-        for (const auto& name : stop_names) {
-            const auto& stop = tc.GetStops().at(name).coordinates;
+        for (const domain::StopId stop_id : stops) {
+            const auto& stop = tc.GetStopCoordinates(stop_id);
+            const std::string name(tc.GetStopName(stop_id));
 
             svg::Text text_underlayer;
             text_underlayer.SetPosition(projector(stop))
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace mapped_file {
+
+    // Массив, который либо владеет элементами (пока структура строится в памяти),
+    // либо смотрит на чужую память, например на отображённый снимок.
+    // Изменять можно только собственный массив; Attach отбрасывает его.
+    template <typename T>
+    class MappedArray {
+    public:
+        MappedArray() = default;
+        MappedArray(std::initializer_list<T> values)
+            : owned_(values) {
+            Sync();
+        }
+        explicit MappedArray(std::vector<T> values)
+            : owned_(std::move(values)) {
+            Sync();
+        }
+
+        MappedArray(const MappedArray&) = delete;
+        MappedArray& operator=(const MappedArray&) = delete;
+
+        // Перемещение вектора сохраняет его буфер, поэтому указатель остаётся верным
+        MappedArray(MappedArray&&) = default;
+        MappedArray& operator=(MappedArray&&) = default;
+
+        void Attach(const T* data, size_t size) {
+            owned_ = {};
+            data_ = data;
+            size_ = size;
+        }
+
+        void reserve(size_t capacity) {
+            owned_.reserve(capacity);
+            Sync();
+        }
+        void push_back(const T& value) {
+            owned_.push_back(value);
+            Sync();
+        }
+        void assign(size_t count, const T& value) {
+            owned_.assign(count, value);
+            Sync();
+        }
+        template <typename It>
+        void assign(It begin, It end) {
+            owned_.assign(begin, end);
+            Sync();
+        }
+        void resize(size_t count) {
+            owned_.resize(count);
+            Sync();
+        }
+        void clear() {
+            owned_.clear();
+            Sync();
+        }
+        T* MutableData() {
+            return owned_.data();
+        }
+
+        const T* data() const {
+            return data_;
+        }
+        size_t size() const {
+            return size_;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+        const T& operator[](size_t index) const {
+            return data_[index];
+        }
+        const T& back() const {
+            return data_[size_ - 1];
+        }
+        const T* begin() const {
+            return data_;
+        }
+        const T* end() const {
+            return data_ + size_;
+        }
+
+    private:
+        void Sync() {
+            data_ = owned_.data();
+            size_ = owned_.size();
+        }
+
+        std::vector<T> owned_;
+        const T* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+}  // namespace mapped_file
@@ -0,0 +1,83 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mapped_file {
+
+    MappedFile::MappedFile(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                size_ = static_cast<size_t>(file_stat.st_size);
+            }
+        }
+        // Отображение остаётся действительным и после закрытия дескриптора
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    bool MappedFile::IsOpen() const {
+        return data_ != nullptr;
+    }
+
+    const char* MappedFile::GetData() const {
+        return data_;
+    }
+
+    size_t MappedFile::GetSize() const {
+        return size_;
+    }
+
+    void WriteSnapshotFile(const std::string& path, const std::function<void(SnapshotWriter&)>& write) {
+        // Своё уникальное имя у каждого писателя: процессы, прогревающие один снимок, не пишут в общий файл
+        std::string temp_path = path + ".XXXXXX";
+        const int fd = mkstemp(temp_path.data());
+        if (fd < 0) {
+            throw std::runtime_error("Cannot write snapshot: " + path);
+        }
+        // mkstemp создаёт файл с правами 0600, а снимок читают и другие пользователи
+        fchmod(fd, 0644);
+        close(fd);
+
+        try {
+            std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+            if (!output) {
+                throw std::runtime_error("Cannot write snapshot: " + temp_path);
+            }
+            SnapshotWriter writer(output);
+            write(writer);
+            if (!output.flush()) {
+                throw std::runtime_error("Cannot write snapshot: " + temp_path);
+            }
+            output.close();
+            if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+                throw std::runtime_error("Cannot write snapshot: " + path);
+            }
+        }
+        catch (...) {
+            std::remove(temp_path.c_str());
+            throw;
+        }
+    }
+
+}  // namespace mapped_file
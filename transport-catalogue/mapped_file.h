@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace mapped_file {
+
+    // Файл, отображённый в память только для чтения.
+    // Как и у std::ifstream, неудачное открытие не бросает исключение — его видно по IsOpen().
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsOpen() const;
+        const char* GetData() const;
+        size_t GetSize() const;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // Снимки — это подряд идущие массивы тривиально копируемых значений, каждый выровнен на 8 байт,
+    // чтобы после отображения файла их можно было читать прямо по указателю
+    inline constexpr size_t SNAPSHOT_ALIGNMENT = 8;
+
+    class SnapshotWriter {
+    public:
+        explicit SnapshotWriter(std::ostream& output)
+            : output_(output) {
+        }
+
+        template <typename T>
+        void Write(const T* data, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            static constexpr char PADDING[SNAPSHOT_ALIGNMENT] = {};
+            const size_t size = sizeof(T) * count;
+            output_.write(reinterpret_cast<const char*>(data), size);
+            output_.write(PADDING, (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT);
+        }
+
+    private:
+        std::ostream& output_;
+    };
+
+    // Возвращает указатели прямо в отображённый файл или nullptr, если массив не помещается
+    class SnapshotReader {
+    public:
+        SnapshotReader(const char* data, size_t size)
+            : data_(data), size_(size) {
+        }
+
+        template <typename T>
+        const T* Read(size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (count > (size_ - offset_) / sizeof(T)) {
+                return nullptr;
+            }
+            const T* result = reinterpret_cast<const T*>(data_ + offset_);
+            const size_t size = sizeof(T) * count;
+            offset_ = std::min(size_, offset_ + size + (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT);
+            return result;
+        }
+
+    private:
+        const char* data_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+
+    // Пишет файл во временный с уникальным именем и переименовывает: уже отображённый снимок
+    // не меняется под читателем. Ошибки записи бросают std::runtime_error, временный файл удаляется.
+    void WriteSnapshotFile(const std::string& path, const std::function<void(SnapshotWriter&)>& write);
+
+}  // namespace mapped_file
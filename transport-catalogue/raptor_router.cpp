@@ -0,0 +1,174 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace router {
+
+    namespace {
+        constexpr size_t NO_ROUTE = std::numeric_limits<size_t>::max();
+        constexpr size_t NO_LABEL = std::numeric_limits<size_t>::max();
+        constexpr double INFINITE_TIME = std::numeric_limits<double>::infinity();
+    }
+
+    RaptorRouter::RaptorRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings)
+        : tc_(tc)
+        , settings_(settings)
+        , bus_velocity_m_per_min_(settings.bus_velocity * 1000.0 / 60.0)
+        , stop_routes_(tc.GetStopCount()) {
+        for (domain::BusId bus = 0; bus < tc_.GetBusCount(); ++bus) {
+            const auto stops = tc_.GetBusStops(bus);
+            if (stops.size() < 2) {
+                continue;
+            }
+            AddRoute(bus, false);
+            if (!tc_.IsBusCircular(bus)) {
+                AddRoute(bus, true);
+            }
+        }
+    }
+
+    void RaptorRouter::AddRoute(domain::BusId bus, bool is_reverse) {
+        const size_t route = routes_.size();
+        const size_t stops_begin = route_stops_.size();
+        const auto stops = tc_.GetBusStops(bus);
+        const size_t first_position = is_reverse ? stops.size() - 1 : 0;
+
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const size_t position = is_reverse ? stops.size() - 1 - i : i;
+            const size_t stop = stops.begin()[position];
+            stop_routes_[stop].push_back({ route, route_stops_.size() });
+            route_stops_.push_back(stop);
+            route_distances_.push_back(tc_.GetBusDistance(bus, first_position, position));
+        }
+
+        routes_.push_back({ bus, stops_begin, route_stops_.size() });
+    }
+
+    double RaptorRouter::GetRideTime(size_t board_position, size_t alight_position) const {
+        const auto distance = route_distances_[alight_position] - route_distances_[board_position];
+        return static_cast<double>(distance) / bus_velocity_m_per_min_;
+    }
+
+    std::optional<RouteInfo> RaptorRouter::FindRoute(domain::StopId from, domain::StopId to) const {
+        if (from >= stop_routes_.size() || to >= stop_routes_.size()
+            || !tc_.IsStopServed(from) || !tc_.IsStopServed(to)) {
+            return std::nullopt;
+        }
+        const size_t source = from;
+        const size_t target = to;
+        const double wait_time = static_cast<double>(settings_.bus_wait_time.count());
+        const size_t stop_count = stop_routes_.size();
+
+        // Метки пишутся только при улучшении: журнал всех улучшений и последняя метка каждой
+        // остановки. Так раунд стоит O(просмотренных маршрутов), а не O(числа остановок)
+        std::vector<Label> labels{ Label{ 0, NO_ROUTE, 0, 0, 0, NO_LABEL } };
+        std::vector<size_t> last_labels(stop_count, NO_LABEL);
+        last_labels[source] = 0;
+
+        // Прибытия к концу предыдущего раунда и лучшие прибытия с учётом текущего
+        std::vector<double> previous_arrivals(stop_count, INFINITE_TIME);
+        previous_arrivals[source] = 0;
+        std::vector<double> best_arrivals = previous_arrivals;
+
+        std::vector<size_t> marked_stops{ source };
+        std::vector<bool> is_marked(stop_count, false);
+        std::vector<size_t> route_start(routes_.size(), NO_ROUTE);
+        std::vector<size_t> queued_routes;
+
+        for (size_t round = 1; !marked_stops.empty(); ++round) {
+            for (const size_t stop : marked_stops) {
+                for (const auto& [route, position] : stop_routes_[stop]) {
+                    if (route_start[route] == NO_ROUTE) {
+                        queued_routes.push_back(route);
+                        route_start[route] = position;
+                    }
+                    else {
+                        route_start[route] = std::min(route_start[route], position);
+                    }
+                }
+            }
+            marked_stops.clear();
+
+            for (const size_t route : queued_routes) {
+                std::optional<size_t> board_position;
+                for (size_t position = route_start[route]; position < routes_[route].stops_end; ++position) {
+                    const size_t stop = route_stops_[position];
+
+                    if (board_position) {
+                        const double arrival = previous_arrivals[route_stops_[*board_position]] + wait_time
+                            + GetRideTime(*board_position, position);
+                        if (arrival < best_arrivals[stop] && arrival < best_arrivals[target]) {
+                            Label label{ arrival, route, *board_position, position, round, last_labels[stop] };
+                            // Повторное улучшение в том же раунде заменяет метку этого раунда
+                            if (last_labels[stop] != NO_LABEL && labels[last_labels[stop]].round == round) {
+                                label.previous = labels[last_labels[stop]].previous;
+                                labels[last_labels[stop]] = label;
+                            }
+                            else {
+                                last_labels[stop] = labels.size();
+                                labels.push_back(label);
+                            }
+                            best_arrivals[stop] = arrival;
+                            if (!is_marked[stop]) {
+                                is_marked[stop] = true;
+                                marked_stops.push_back(stop);
+                            }
+                        }
+                    }
+
+                    // Сесть здесь выгоднее, чем ехать дальше уже выбранным рейсом
+                    const double boarding_time = previous_arrivals[stop];
+                    if (boarding_time < INFINITE_TIME
+                        && (!board_position
+                            || boarding_time < previous_arrivals[route_stops_[*board_position]]
+                                + GetRideTime(*board_position, position))) {
+                        board_position = position;
+                    }
+                }
+                route_start[route] = NO_ROUTE;
+            }
+            queued_routes.clear();
+
+            for (const size_t stop : marked_stops) {
+                is_marked[stop] = false;
+                previous_arrivals[stop] = best_arrivals[stop];
+            }
+        }
+
+        if (best_arrivals[target] == INFINITE_TIME) {
+            return std::nullopt;
+        }
+
+        std::vector<RouteItem> items;
+        const Label* label = &labels[last_labels[target]];
+        while (label->route != NO_ROUTE) {
+            const Route& route = routes_[label->route];
+            const size_t board_stop = route_stops_[label->board_position];
+            items.push_back(RouteItem{
+                RouteItem::Type::Bus,
+                "",
+                std::string(tc_.GetBusName(route.bus)),
+                GetRideTime(label->board_position, label->alight_position),
+                label->alight_position - label->board_position
+                });
+            items.push_back(RouteItem{
+                RouteItem::Type::Wait,
+                std::string(tc_.GetStopName(static_cast<domain::StopId>(board_stop))),
+                "",
+                wait_time,
+                0
+                });
+            // Посадка опиралась на метку остановки из предыдущего раунда
+            size_t board_label = last_labels[board_stop];
+            while (labels[board_label].round >= label->round) {
+                board_label = labels[board_label].previous;
+            }
+            label = &labels[board_label];
+        }
+        std::reverse(items.begin(), items.end());
+
+        return RouteInfo{ best_arrivals[target], std::move(items) };
+    }
+
+}  // namespace router
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace router {
+
+    // RAPTOR: маршрутизация прямо по последовательностям остановок автобусов, без графа.
+    // Раунд k находит лучшие времена прибытия ровно с k поездками: каждый маршрут
+    // просматривается один раз от самой ранней остановки, улучшенной в предыдущем раунде.
+    // Память — O(суммы длин маршрутов) вместо O(k²) рёбер на автобус.
+    class RaptorRouter {
+    public:
+        RaptorRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings);
+
+        std::optional<RouteInfo> FindRoute(domain::StopId from, domain::StopId to) const;
+
+    private:
+        // Один автобус в одном направлении
+        struct Route {
+            domain::BusId bus;
+            size_t stops_begin;
+            size_t stops_end;
+        };
+
+        struct StopRoute {
+            size_t route;
+            size_t position;
+        };
+
+        // Улучшение прибытия на остановку; previous — прошлая метка той же остановки в журнале
+        struct Label {
+            double arrival;
+            size_t route;
+            size_t board_position;
+            size_t alight_position;
+            size_t round;
+            size_t previous;
+        };
+
+        void AddRoute(domain::BusId bus, bool is_reverse);
+
+        double GetRideTime(size_t board_position, size_t alight_position) const;
+
+        const transport_catalogue::TransportCatalogue& tc_;
+        RoutingSettings settings_;
+        double bus_velocity_m_per_min_;
+
+        // Индексы остановок совпадают с id каталога; искать можно только от обслуживаемых остановок
+        std::vector<std::vector<StopRoute>> stop_routes_;
+
+        std::vector<Route> routes_;
+        // Остановки всех маршрутов подряд и накопленная дорожная длина до каждой из них
+        std::vector<size_t> route_stops_;
+        std::vector<int64_t> route_distances_;
+    };
+
+}  // namespace router
@@ -0,0 +1,100 @@
+#include "relax_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RELAX_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+    void RelaxRowScalar(float weight_from,
+                        const float* weights_through, const uint32_t* prev_edges_through,
+                        float* weights, uint32_t* prev_edges, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const float candidate_weight = weight_from + weights_through[i];
+            if (candidate_weight < weights[i]) {
+                weights[i] = candidate_weight;
+                prev_edges[i] = prev_edges_through[i];
+            }
+        }
+    }
+
+#ifdef RELAX_KERNEL_X86
+    namespace {
+
+        __attribute__((target("avx2")))
+        void RelaxRowAvx2(float weight_from,
+                          const float* weights_through, const uint32_t* prev_edges_through,
+                          float* weights, uint32_t* prev_edges, size_t count) {
+            const __m256 from = _mm256_set1_ps(weight_from);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 candidate = _mm256_add_ps(from, _mm256_loadu_ps(weights_through + i));
+                const __m256 current = _mm256_loadu_ps(weights + i);
+                const __m256 mask = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+                if (_mm256_movemask_ps(mask) == 0) {
+                    continue;
+                }
+                _mm256_storeu_ps(weights + i, _mm256_blendv_ps(current, candidate, mask));
+
+                const __m256 prev = _mm256_castsi256_ps(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges + i)));
+                const __m256 prev_through = _mm256_castsi256_ps(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges + i),
+                                    _mm256_castps_si256(_mm256_blendv_ps(prev, prev_through, mask)));
+            }
+            RelaxRowScalar(weight_from, weights_through + i, prev_edges_through + i,
+                           weights + i, prev_edges + i, count - i);
+        }
+
+        __attribute__((target("sse4.1")))
+        void RelaxRowSse41(float weight_from,
+                           const float* weights_through, const uint32_t* prev_edges_through,
+                           float* weights, uint32_t* prev_edges, size_t count) {
+            const __m128 from = _mm_set1_ps(weight_from);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 candidate = _mm_add_ps(from, _mm_loadu_ps(weights_through + i));
+                const __m128 current = _mm_loadu_ps(weights + i);
+                const __m128 mask = _mm_cmplt_ps(candidate, current);
+                if (_mm_movemask_ps(mask) == 0) {
+                    continue;
+                }
+                _mm_storeu_ps(weights + i, _mm_blendv_ps(current, candidate, mask));
+
+                const __m128 prev = _mm_castsi128_ps(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + i)));
+                const __m128 prev_through = _mm_castsi128_ps(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + i),
+                                 _mm_castps_si128(_mm_blendv_ps(prev, prev_through, mask)));
+            }
+            RelaxRowScalar(weight_from, weights_through + i, prev_edges_through + i,
+                           weights + i, prev_edges + i, count - i);
+        }
+
+        RelaxRowFunction DetectRelaxRowFunction() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return RelaxRowAvx2;
+            }
+            if (__builtin_cpu_supports("sse4.1")) {
+                return RelaxRowSse41;
+            }
+            return RelaxRowScalar;
+        }
+
+    }  // namespace
+
+    RelaxRowFunction GetRelaxRowFunction() {
+        static const RelaxRowFunction function = DetectRelaxRowFunction();
+        return function;
+    }
+#else
+    RelaxRowFunction GetRelaxRowFunction() {
+        return RelaxRowScalar;
+    }
+#endif
+
+}  // namespace graph
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    // Min-plus релаксация строки матрицы маршрутов через промежуточную вершину:
+    // для всех i из [0, count), где weight_from + weights_through[i] < weights[i],
+    // записывает новый вес и берёт последнее ребро из prev_edges_through[i].
+    using RelaxRowFunction = void (*)(float weight_from,
+                                      const float* weights_through, const uint32_t* prev_edges_through,
+                                      float* weights, uint32_t* prev_edges, size_t count);
+
+    void RelaxRowScalar(float weight_from,
+                        const float* weights_through, const uint32_t* prev_edges_through,
+                        float* weights, uint32_t* prev_edges, size_t count);
+
+    // Лучшая реализация для текущего процессора: AVX (8 float), SSE4.1 (4 float) или скалярная.
+    // Выбирается один раз по флагам CPU.
+    RelaxRowFunction GetRelaxRowFunction();
+
+}  // namespace graph
@@ -6,22 +6,25 @@ namespace request_handler {
     RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& db)
         : db_(db) {}
 
-    std::optional<std::vector<BusDetails>> RequestHandler::GetBusesByStop(const std::string& stop_name) const {
-        auto buses_opt = db_.GetBusesByStop(stop_name);
-        if (!buses_opt) {
+    std::optional<transport_catalogue::TransportCatalogue::BusesRange>
+    RequestHandler::GetBusesByStop(std::string_view stop_name) const {
+        const auto stop = db_.FindStopId(stop_name);
+        if (!stop) {
             return std::nullopt;
         }
+        return db_.GetBusesByStop(*stop);
+    }
 
-        std::vector<BusDetails> bus_details;
-        for (const auto& bus_name : *buses_opt) {
-            bus_details.push_back({ bus_name });
-        }
-
-        return bus_details;
+    std::string_view RequestHandler::GetBusName(domain::BusId bus) const {
+        return db_.GetBusName(bus);
     }
 
-    domain::BusInfo RequestHandler::GetBusInfo(const std::string& bus_name) const {
-        return db_.GetBusInfo(bus_name);
+    const domain::BusInfo& RequestHandler::GetBusInfo(std::string_view bus_name) const {
+        const auto bus = db_.FindBusId(bus_name);
+        if (!bus) {
+            throw std::out_of_range("Bus not found");
+        }
+        return db_.GetBusInfo(*bus);
     }
 
 } // namespace request_handler
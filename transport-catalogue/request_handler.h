@@ -1,22 +1,20 @@
 #pragma once
 #include "transport_catalogue.h"
 #include <string>
-#include <vector>
+#include <string_view>
 #include <optional>
 
 namespace request_handler {
 
-    struct BusDetails {
-        std::string name;
-    };
-
     class RequestHandler {
     public:
         RequestHandler(const transport_catalogue::TransportCatalogue& db);
 
-        std::optional<std::vector<BusDetails>> GetBusesByStop(const std::string& stop_name) const;
+        // Автобусы остановки в порядке имён, без копирования; nullopt — такой остановки нет
+        std::optional<transport_catalogue::TransportCatalogue::BusesRange> GetBusesByStop(std::string_view stop_name) const;
+        std::string_view GetBusName(domain::BusId bus) const;
 
-        domain::BusInfo GetBusInfo(const std::string& bus_name) const;
+        const domain::BusInfo& GetBusInfo(std::string_view bus_name) const;
 
     private:
         const transport_catalogue::TransportCatalogue& db_;
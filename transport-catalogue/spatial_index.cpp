@@ -0,0 +1,209 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace transport_catalogue {
+
+    namespace {
+
+        constexpr double DEGREE = M_PI / 180.0;
+
+    }  // namespace
+
+    void SpatialIndex::Build(const geo::Coordinates* coordinates, size_t count) {
+        cell_offsets_.clear();
+        cell_stops_.clear();
+        cell_coordinates_.clear();
+        rows_ = 0;
+        columns_ = 0;
+        if (count == 0) {
+            return;
+        }
+
+        min_ = max_ = coordinates[0];
+        for (size_t stop = 1; stop < count; ++stop) {
+            min_.lat = std::min(min_.lat, coordinates[stop].lat);
+            min_.lng = std::min(min_.lng, coordinates[stop].lng);
+            max_.lat = std::max(max_.lat, coordinates[stop].lat);
+            max_.lng = std::max(max_.lng, coordinates[stop].lng);
+        }
+
+        // Стороны сетки пропорциональны сторонам охватывающего прямоугольника в метрах
+        const double height = max_.lat - min_.lat;
+        const double width = (max_.lng - min_.lng) * std::cos((min_.lat + max_.lat) / 2 * DEGREE);
+        const size_t cell_count = std::max<size_t>(1, count / STOPS_PER_CELL);
+        if (height <= 0 || width <= 0) {
+            rows_ = height > 0 ? cell_count : 1;
+            columns_ = width > 0 ? cell_count : 1;
+        }
+        else {
+            const double cell_side = std::sqrt(height * width / static_cast<double>(cell_count));
+            rows_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(height / cell_side)), 1, cell_count);
+            columns_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(width / cell_side)), 1, cell_count);
+        }
+        cell_lat_ = height > 0 ? height / static_cast<double>(rows_) : 1;
+        cell_lng_ = max_.lng > min_.lng ? (max_.lng - min_.lng) / static_cast<double>(columns_) : 1;
+
+        // Раскладка подсчётом, как у автобусов по остановкам в каталоге
+        std::vector<size_t> cells(count);
+        cell_offsets_.assign(rows_ * columns_ + 1, 0);
+        for (size_t stop = 0; stop < count; ++stop) {
+            cells[stop] = GetRow(coordinates[stop].lat) * columns_ + GetColumn(coordinates[stop].lng);
+            ++cell_offsets_[cells[stop] + 1];
+        }
+        for (size_t cell = 0; cell + 1 < cell_offsets_.size(); ++cell) {
+            cell_offsets_[cell + 1] += cell_offsets_[cell];
+        }
+
+        cell_stops_.resize(count);
+        cell_coordinates_.resize(count);
+        std::vector<size_t> positions(cell_offsets_.begin(), cell_offsets_.end() - 1);
+        for (size_t stop = 0; stop < count; ++stop) {
+            const size_t position = positions[cells[stop]]++;
+            cell_stops_[position] = static_cast<domain::StopId>(stop);
+            cell_coordinates_[position] = coordinates[stop];
+        }
+    }
+
+    std::vector<SpatialIndex::Neighbor> SpatialIndex::FindNearest(geo::Coordinates center, size_t count,
+                                                                  double max_distance) const {
+        if (count == 0 || cell_stops_.empty()) {
+            return {};
+        }
+
+        // Худший из найденных на вершине кучи
+        auto is_closer = [](const Neighbor& lhs, const Neighbor& rhs) {
+            return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.stop < rhs.stop);
+        };
+        std::priority_queue<Neighbor, std::vector<Neighbor>, decltype(is_closer)> nearest(is_closer);
+
+        auto visit_cell = [&](size_t row, size_t column) {
+            const size_t cell = row * columns_ + column;
+            for (size_t position = cell_offsets_[cell]; position < cell_offsets_[cell + 1]; ++position) {
+                const Neighbor candidate{ cell_stops_[position],
+                                          geo::ComputeDistance(center, cell_coordinates_[position]) };
+                if (candidate.distance > max_distance) {
+                    continue;
+                }
+                if (nearest.size() < count) {
+                    nearest.push(candidate);
+                }
+                else if (is_closer(candidate, nearest.top())) {
+                    nearest.pop();
+                    nearest.push(candidate);
+                }
+            }
+        };
+
+        const size_t center_row = GetRow(center.lat);
+        const size_t center_column = GetColumn(center.lng);
+        for (size_t ring = 0;; ++ring) {
+            const size_t first_row = center_row - std::min(ring, center_row);
+            const size_t last_row = std::min(rows_ - 1, center_row + ring);
+            const size_t first_column = center_column - std::min(ring, center_column);
+            const size_t last_column = std::min(columns_ - 1, center_column + ring);
+
+            // Кольцо ring — ячейки на расстоянии ровно ring по строкам или по столбцам
+            for (size_t row = first_row; row <= last_row; ++row) {
+                if (row + ring == center_row || row == center_row + ring) {
+                    for (size_t column = first_column; column <= last_column; ++column) {
+                        visit_cell(row, column);
+                    }
+                    continue;
+                }
+                if (ring <= center_column) {
+                    visit_cell(row, center_column - ring);
+                }
+                if (center_column + ring < columns_) {
+                    visit_cell(row, center_column + ring);
+                }
+            }
+
+            // Кольца покрыли всю сетку: смотреть больше негде, даже если не набралось count остановок
+            if (first_row == 0 && last_row + 1 == rows_ && first_column == 0 && last_column + 1 == columns_) {
+                break;
+            }
+
+            // Непросмотренные ячейки лежат за одной из сторон прямоугольника колец
+            double bound = std::numeric_limits<double>::infinity();
+            if (first_row > 0) {
+                const double edge = min_.lat + static_cast<double>(first_row) * cell_lat_;
+                bound = std::min(bound, geo::EARTH_RADIUS * std::max(0.0, center.lat - edge) * DEGREE);
+            }
+            if (last_row + 1 < rows_) {
+                const double edge = min_.lat + static_cast<double>(last_row + 1) * cell_lat_;
+                bound = std::min(bound, geo::EARTH_RADIUS * std::max(0.0, edge - center.lat) * DEGREE);
+            }
+            if (first_column > 0) {
+                const double edge = min_.lng + static_cast<double>(first_column) * cell_lng_;
+                bound = std::min(bound, GetLongitudeBound(center, center.lng - edge));
+            }
+            if (last_column + 1 < columns_) {
+                const double edge = min_.lng + static_cast<double>(last_column + 1) * cell_lng_;
+                bound = std::min(bound, GetLongitudeBound(center, edge - center.lng));
+            }
+            if (bound > max_distance || (nearest.size() == count && bound >= nearest.top().distance)) {
+                break;
+            }
+        }
+
+        std::vector<Neighbor> result(nearest.size());
+        for (auto it = result.rbegin(); it != result.rend(); ++it) {
+            *it = nearest.top();
+            nearest.pop();
+        }
+        return result;
+    }
+
+    std::vector<domain::StopId> SpatialIndex::FindInBox(geo::Coordinates min, geo::Coordinates max) const {
+        std::vector<domain::StopId> result;
+        if (cell_stops_.empty() || min.lat > max.lat || min.lng > max.lng
+            || max.lat < min_.lat || min.lat > max_.lat || max.lng < min_.lng || min.lng > max_.lng)
+        {
+            return result;
+        }
+
+        const size_t last_row = GetRow(max.lat);
+        const size_t last_column = GetColumn(max.lng);
+        for (size_t row = GetRow(min.lat); row <= last_row; ++row) {
+            const size_t first_cell = row * columns_ + GetColumn(min.lng);
+            const size_t last_cell = row * columns_ + last_column;
+            // Ячейки строки идут подряд, поэтому их остановки — один непрерывный отрезок
+            for (size_t position = cell_offsets_[first_cell]; position < cell_offsets_[last_cell + 1]; ++position) {
+                const geo::Coordinates& coordinates = cell_coordinates_[position];
+                if (coordinates.lat >= min.lat && coordinates.lat <= max.lat
+                    && coordinates.lng >= min.lng && coordinates.lng <= max.lng)
+                {
+                    result.push_back(cell_stops_[position]);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    size_t SpatialIndex::GetColumn(double lng) const {
+        const double column = std::floor((lng - min_.lng) / cell_lng_);
+        return column <= 0 ? 0 : std::min(columns_ - 1, static_cast<size_t>(column));
+    }
+
+    size_t SpatialIndex::GetRow(double lat) const {
+        const double row = std::floor((lat - min_.lat) / cell_lat_);
+        return row <= 0 ? 0 : std::min(rows_ - 1, static_cast<size_t>(row));
+    }
+
+    // По формуле гаверсинусов sin(d / 2R) >= cos(φ) * sin(Δλ / 2), где φ — наибольшая по модулю
+    // широта обеих точек; для остановок она не больше наибольшей широты сетки
+    double SpatialIndex::GetLongitudeBound(geo::Coordinates center, double delta_lng) const {
+        delta_lng = std::clamp(delta_lng, 0.0, 360.0);
+        delta_lng = std::min(delta_lng, 360.0 - delta_lng);
+        const double max_lat = std::max({ std::abs(center.lat), std::abs(min_.lat), std::abs(max_.lat) });
+        const double sine = std::cos(std::min(max_lat, 90.0) * DEGREE) * std::sin(delta_lng / 2 * DEGREE);
+        return 2 * geo::EARTH_RADIUS * std::asin(std::min(1.0, sine));
+    }
+
+}  // namespace transport_catalogue
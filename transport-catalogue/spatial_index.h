@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "domain.h"
+#include "geo.h"
+
+namespace transport_catalogue {
+
+    // Равномерная сетка по широте и долготе над координатами остановок.
+    // Ячейки подобраны так, чтобы в каждой было около двух остановок; остановки лежат
+    // подряд по ячейкам вместе с копией координат, поэтому запрос читает память линейно.
+    // Ближайшие ищутся обходом колец ячеек вокруг точки, пока нижняя оценка расстояния
+    // до ещё не просмотренных ячеек не превысит худшего из найденных.
+    class SpatialIndex {
+    public:
+        struct Neighbor {
+            domain::StopId stop;
+            double distance;
+        };
+
+        void Build(const geo::Coordinates* coordinates, size_t count);
+
+        // До count ближайших остановок не дальше max_distance метров, по возрастанию расстояния
+        std::vector<Neighbor> FindNearest(geo::Coordinates center, size_t count, double max_distance) const;
+        // Остановки внутри прямоугольника [min, max] по возрастанию id
+        std::vector<domain::StopId> FindInBox(geo::Coordinates min, geo::Coordinates max) const;
+
+    private:
+        static constexpr size_t STOPS_PER_CELL = 2;
+
+        size_t GetColumn(double lng) const;
+        size_t GetRow(double lat) const;
+        // Нижняя оценка расстояния от center до точки, отстоящей по долготе на delta_lng градусов
+        double GetLongitudeBound(geo::Coordinates center, double delta_lng) const;
+
+        geo::Coordinates min_{ 0, 0 };
+        geo::Coordinates max_{ 0, 0 };
+        double cell_lat_ = 1;
+        double cell_lng_ = 1;
+        size_t rows_ = 0;
+        size_t columns_ = 0;
+        // Остановки ячейки cell — cell_stops_[cell_offsets_[cell], cell_offsets_[cell + 1]),
+        // ячейки пронумерованы по строкам
+        std::vector<size_t> cell_offsets_;
+        std::vector<domain::StopId> cell_stops_;
+        std::vector<geo::Coordinates> cell_coordinates_;
+    };
+
+}  // namespace transport_catalogue
@@ -0,0 +1,454 @@
+#include "streaming_loader.h"
+
+#include <stdexcept>
+
+namespace json_reader {
+
+    using namespace std::literals;
+
+    namespace {
+
+        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        // Теги событий в контрольной сумме
+        constexpr char NULL_TAG = 'n';
+        constexpr char BOOL_TAG = 'b';
+        constexpr char INT_TAG = 'i';
+        constexpr char DOUBLE_TAG = 'd';
+        constexpr char STRING_TAG = 's';
+        constexpr char KEY_TAG = 'k';
+        constexpr char START_ARRAY_TAG = '[';
+        constexpr char END_ARRAY_TAG = ']';
+        constexpr char START_DICT_TAG = '{';
+        constexpr char END_DICT_TAG = '}';
+
+        [[noreturn]] void ThrowDuplicateKey(std::string_view key) {
+            throw json::ParsingError("Duplicate key '"s + std::string(key) + "' have been found");
+        }
+
+        template <typename T>
+        std::string_view AsBytes(const T& value) {
+            return { reinterpret_cast<const char*>(&value), sizeof(value) };
+        }
+
+    }  // namespace
+
+    void StreamingLoader::Null() {
+        Hash(NULL_TAG);
+        switch (state_) {
+        case State::Value:
+            value_handler_.Null();
+            EndValue();
+            break;
+        case State::Skip:
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::Bool(bool value) {
+        Hash(BOOL_TAG, AsBytes(value));
+        switch (state_) {
+        case State::Value:
+            value_handler_.Bool(value);
+            EndValue();
+            break;
+        case State::Request:
+            if (field_ == Field::IsRoundtrip) {
+                request_.is_roundtrip = value;
+            }
+            else {
+                CheckOtherField();
+            }
+            break;
+        case State::Skip:
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::Int(int value) {
+        Hash(INT_TAG, AsBytes(value));
+        switch (state_) {
+        case State::Value:
+            value_handler_.Int(value);
+            EndValue();
+            break;
+        case State::Request:
+            // Целое подходит и как double, как в Node::AsDouble
+            SetCoordinate(value);
+            break;
+        case State::RoadDistances:
+            request_.road_distances.emplace_back(road_distance_stop_, value);
+            break;
+        case State::Skip:
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::Double(double value) {
+        Hash(DOUBLE_TAG, AsBytes(value));
+        switch (state_) {
+        case State::Value:
+            value_handler_.Double(value);
+            EndValue();
+            break;
+        case State::Request:
+            SetCoordinate(value);
+            break;
+        case State::Skip:
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::String(std::string_view value) {
+        Hash(STRING_TAG, value);
+        switch (state_) {
+        case State::Value:
+            value_handler_.String(value);
+            EndValue();
+            break;
+        case State::Request:
+            if (field_ == Field::Type) {
+                request_.type = value == "Stop"sv ? RequestType::Stop
+                    : value == "Bus"sv ? RequestType::Bus
+                    : RequestType::Other;
+            }
+            else if (field_ == Field::Name) {
+                request_.name = names_.Intern(value);
+            }
+            else {
+                CheckOtherField();
+            }
+            break;
+        case State::Stops:
+            request_.stops.push_back(names_.Intern(value));
+            break;
+        case State::Skip:
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::StartArray() {
+        Hash(START_ARRAY_TAG);
+        switch (state_) {
+        case State::Value:
+            value_handler_.StartArray();
+            ++value_depth_;
+            break;
+        case State::BaseRequestsStart:
+            state_ = State::BaseRequests;
+            break;
+        case State::Request:
+            if (field_ == Field::Stops) {
+                request_.has_stops = true;
+                state_ = State::Stops;
+            }
+            else {
+                CheckOtherField();
+                SkipValue();
+            }
+            break;
+        case State::Skip:
+            ++skip_depth_;
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::EndArray() {
+        Hash(END_ARRAY_TAG);
+        switch (state_) {
+        case State::Value:
+            value_handler_.EndArray();
+            --value_depth_;
+            EndValue();
+            break;
+        case State::BaseRequests:
+            has_base_requests_ = true;
+            state_ = State::Root;
+            break;
+        case State::Stops:
+            state_ = State::Request;
+            break;
+        case State::Skip:
+            if (--skip_depth_ == 0) {
+                state_ = State::Request;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void StreamingLoader::StartDict() {
+        Hash(START_DICT_TAG);
+        switch (state_) {
+        case State::Document:
+            state_ = State::Root;
+            break;
+        case State::Value:
+            value_handler_.StartDict();
+            ++value_depth_;
+            break;
+        case State::BaseRequests:
+            state_ = State::Request;
+            field_ = Field::Other;
+            break;
+        case State::Request:
+            if (field_ == Field::RoadDistances) {
+                request_.has_road_distances = true;
+                road_distance_stops_.clear();
+                state_ = State::RoadDistances;
+            }
+            else {
+                CheckOtherField();
+                SkipValue();
+                SkipDict();
+            }
+            break;
+        case State::Skip:
+            ++skip_depth_;
+            SkipDict();
+            break;
+        default:
+            CheckOtherField();
+            break;
+        }
+    }
+
+    void StreamingLoader::Key(std::string_view key) {
+        Hash(KEY_TAG, key);
+        switch (state_) {
+        case State::Root:
+            if (root_.count(key) > 0 || (key == "base_requests"sv && has_base_requests_)) {
+                ThrowDuplicateKey(key);
+            }
+            if (key == "base_requests"sv) {
+                state_ = State::BaseRequestsStart;
+            }
+            else {
+                value_key_ = key;
+                value_depth_ = 0;
+                state_ = State::Value;
+            }
+            break;
+        case State::Value:
+            value_handler_.Key(key);
+            break;
+        case State::Request:
+            field_ = key == "type"sv ? Field::Type
+                : key == "name"sv ? Field::Name
+                : key == "latitude"sv ? Field::Latitude
+                : key == "longitude"sv ? Field::Longitude
+                : key == "road_distances"sv ? Field::RoadDistances
+                : key == "stops"sv ? Field::Stops
+                : key == "is_roundtrip"sv ? Field::IsRoundtrip
+                : Field::Other;
+            if (field_ == Field::Other) {
+                if (!request_.other_keys.emplace(key).second) {
+                    ThrowDuplicateKey(key);
+                }
+            }
+            else {
+                const uint32_t bit = 1u << static_cast<uint32_t>(field_);
+                if (request_.seen_fields & bit) {
+                    ThrowDuplicateKey(key);
+                }
+                request_.seen_fields |= bit;
+            }
+            break;
+        case State::RoadDistances:
+            road_distance_stop_ = names_.Intern(key);
+            if (!road_distance_stops_.insert(road_distance_stop_).second) {
+                ThrowDuplicateKey(key);
+            }
+            break;
+        case State::Skip:
+            if (!skip_keys_.back().emplace(key).second) {
+                ThrowDuplicateKey(key);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void StreamingLoader::EndDict() {
+        Hash(END_DICT_TAG);
+        switch (state_) {
+        case State::Root:
+            state_ = State::Done;
+            break;
+        case State::Value:
+            value_handler_.EndDict();
+            --value_depth_;
+            EndValue();
+            break;
+        case State::Request:
+            CommitRequest();
+            state_ = State::BaseRequests;
+            break;
+        case State::RoadDistances:
+            state_ = State::Request;
+            break;
+        case State::Skip:
+            skip_keys_.pop_back();
+            if (--skip_depth_ == 0) {
+                state_ = State::Request;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool StreamingLoader::HasBaseRequests() const {
+        return has_base_requests_;
+    }
+
+    const transport_catalogue::CatalogueBuilder& StreamingLoader::GetBuilder() const {
+        return builder_;
+    }
+
+    uint64_t StreamingLoader::GetBaseChecksum() const {
+        return base_checksum_;
+    }
+
+    json::Dict StreamingLoader::TakeRoot() {
+        return std::move(root_);
+    }
+
+    void StreamingLoader::SetCoordinate(double value) {
+        if (field_ == Field::Latitude) {
+            request_.latitude = value;
+        }
+        else if (field_ == Field::Longitude) {
+            request_.longitude = value;
+        }
+        else {
+            CheckOtherField();
+        }
+    }
+
+    // Значение верхнего уровня готово, когда закрыт его внешний контейнер
+    void StreamingLoader::EndValue() {
+        if (value_depth_ == 0) {
+            root_.emplace(std::move(value_key_), value_handler_.TakeRoot());
+            state_ = State::Root;
+        }
+    }
+
+    void StreamingLoader::SkipValue() {
+        skip_depth_ = 1;
+        state_ = State::Skip;
+    }
+
+    void StreamingLoader::SkipDict() {
+        skip_keys_.emplace_back();
+    }
+
+    void StreamingLoader::CommitRequest() {
+        Request& request = request_;
+        if (!request.type) {
+            throw std::out_of_range("Base request without type"s);
+        }
+
+        if (*request.type == RequestType::Stop) {
+            if (!request.name || !request.latitude || !request.longitude || !request.has_road_distances) {
+                throw std::out_of_range("Incomplete Stop request"s);
+            }
+            builder_.AddStop(*request.name, { *request.latitude, *request.longitude });
+            for (const auto& [stop, distance] : request.road_distances) {
+                builder_.AddDistance(*request.name, stop, distance);
+            }
+        }
+        else if (*request.type == RequestType::Bus) {
+            if (!request.name || !request.has_stops || !request.is_roundtrip) {
+                throw std::out_of_range("Incomplete Bus request"s);
+            }
+            builder_.AddBus(*request.name, request.stops, *request.is_roundtrip);
+        }
+
+        // Векторы очищаются, а не пересоздаются, чтобы переиспользовать их память
+        request.type.reset();
+        request.name.reset();
+        request.latitude.reset();
+        request.longitude.reset();
+        request.is_roundtrip.reset();
+        request.has_road_distances = false;
+        request.has_stops = false;
+        request.seen_fields = 0;
+        request.other_keys.clear();
+        request.road_distances.clear();
+        request.stops.clear();
+    }
+
+    // Значение неожиданного типа: сообщение то же, что бросил бы метод As* при разборе дерева
+    void StreamingLoader::CheckOtherField() const {
+        switch (state_) {
+        case State::Document:
+        case State::BaseRequests:
+            throw std::logic_error("Not a dict"s);
+        case State::BaseRequestsStart:
+            throw std::logic_error("Not an array"s);
+        case State::RoadDistances:
+            throw std::logic_error("Not an int"s);
+        case State::Stops:
+            throw std::logic_error("Not a string"s);
+        default:
+            break;
+        }
+
+        switch (field_) {
+        case Field::Other:
+            return;
+        case Field::Latitude:
+        case Field::Longitude:
+            throw std::logic_error("Not a double"s);
+        case Field::RoadDistances:
+            throw std::logic_error("Not a dict"s);
+        case Field::Stops:
+            throw std::logic_error("Not an array"s);
+        case Field::IsRoundtrip:
+            throw std::logic_error("Not a bool"s);
+        default:
+            throw std::logic_error("Not a string"s);
+        }
+    }
+
+    // Сумма считается только по событиям внутри base_requests
+    void StreamingLoader::Hash(char tag, std::string_view payload) {
+        if (state_ == State::Document || state_ == State::Root || state_ == State::Value || state_ == State::Done) {
+            return;
+        }
+        auto mix = [this](char c) {
+            base_checksum_ ^= static_cast<unsigned char>(c);
+            base_checksum_ *= FNV_PRIME;
+        };
+        mix(tag);
+        const size_t size = payload.size();
+        for (const char c : AsBytes(size)) {
+            mix(c);
+        }
+        for (const char c : payload) {
+            mix(c);
+        }
+    }
+
+}  // namespace json_reader
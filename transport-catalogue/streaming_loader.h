@@ -0,0 +1,124 @@
+#pragma once
+
+#include "catalogue_builder.h"
+#include "json.h"
+#include "string_pool.h"
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace json_reader {
+
+    // Принимает события разбора всего входного документа. Массив base_requests не превращается
+    // в дерево: каждый запрос собирается по мере чтения и сразу передаётся в CatalogueBuilder.
+    // Имена хранятся один раз в пуле строк, а до конца запроса копятся только его расстояния
+    // и остановки, поэтому память растёт с каталогом, а не с текстом. Остальные ключи верхнего
+    // уровня собираются в обычные узлы. Ошибки типов полей запроса те же, что у методов As* узла.
+    class StreamingLoader final : public json::Handler {
+    public:
+        void Null() override;
+        void Bool(bool value) override;
+        void Int(int value) override;
+        void Double(double value) override;
+        void String(std::string_view value) override;
+        void StartArray() override;
+        void EndArray() override;
+        void StartDict() override;
+        void Key(std::string_view key) override;
+        void EndDict() override;
+
+        bool HasBaseRequests() const;
+        // Имена в построителе указывают в пул загрузчика: Build нужно вызвать, пока загрузчик жив
+        const transport_catalogue::CatalogueBuilder& GetBuilder() const;
+        // FNV-1a от событий base_requests
+        uint64_t GetBaseChecksum() const;
+        // Ключи верхнего уровня, кроме base_requests
+        json::Dict TakeRoot();
+
+    private:
+        enum class State {
+            Document,
+            Root,
+            Value,
+            BaseRequestsStart,
+            BaseRequests,
+            Request,
+            RoadDistances,
+            Stops,
+            Skip,
+            Done,
+        };
+
+        enum class Field {
+            Other,
+            Type,
+            Name,
+            Latitude,
+            Longitude,
+            RoadDistances,
+            Stops,
+            IsRoundtrip,
+        };
+
+        enum class RequestType {
+            Other,
+            Stop,
+            Bus,
+        };
+
+        struct Request {
+            std::optional<RequestType> type;
+            std::optional<std::string_view> name;
+            std::optional<double> latitude;
+            std::optional<double> longitude;
+            std::optional<bool> is_roundtrip;
+            bool has_road_distances = false;
+            bool has_stops = false;
+            // Встреченные ключи: известные поля битами Field, остальные по имени
+            uint32_t seen_fields = 0;
+            std::set<std::string, std::less<>> other_keys;
+            std::vector<std::pair<std::string_view, int>> road_distances;
+            std::vector<std::string_view> stops;
+        };
+
+        void SetCoordinate(double value);
+        void EndValue();
+        void SkipValue();
+        void SkipDict();
+        void CommitRequest();
+        // Бросает std::logic_error, если значение не подходит к текущему месту в запросе;
+        // значения неизвестных полей пропускаются
+        void CheckOtherField() const;
+        void Hash(char tag, std::string_view payload = {});
+
+        State state_ = State::Document;
+        // Значение верхнего уровня, которое сейчас собирается в дерево, и его глубина
+        json::TreeHandler value_handler_;
+        std::string value_key_;
+        size_t value_depth_ = 0;
+        // Вложенность пропускаемого значения внутри запроса
+        size_t skip_depth_ = 0;
+        // Ключи открытых пропускаемых словарей: дубликаты в них тоже ошибка разбора
+        std::vector<std::set<std::string, std::less<>>> skip_keys_;
+
+        json::Dict root_;
+        bool has_base_requests_ = false;
+        uint64_t base_checksum_ = 14695981039346656037ULL;
+
+        Field field_ = Field::Other;
+        std::string_view road_distance_stop_;
+        // Остановки текущего словаря road_distances; имена указывают в пул
+        std::unordered_set<std::string_view> road_distance_stops_;
+        Request request_;
+
+        string_pool::StringPool names_;
+        transport_catalogue::CatalogueBuilder builder_;
+    };
+
+}  // namespace json_reader
@@ -0,0 +1,46 @@
+#include "string_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace string_pool {
+
+    std::string_view StringPool::Intern(std::string_view value) {
+        if (const auto it = interned_.find(value); it != interned_.end()) {
+            return *it;
+        }
+
+        char* data = Allocate(value.size());
+        std::memcpy(data, value.data(), value.size());
+        const std::string_view interned(data, value.size());
+        interned_.insert(interned);
+        return interned;
+    }
+
+    size_t StringPool::GetSize() const {
+        return interned_.size();
+    }
+
+    size_t StringPool::GetAllocatedBytes() const {
+        return allocated_bytes_;
+    }
+
+    char* StringPool::Allocate(size_t size) {
+        if (size > remaining_) {
+            // Длинная строка получает собственный блок, а текущий остаётся недозаполненным
+            const size_t block_size = std::max(size, BLOCK_SIZE);
+            blocks_.push_back(std::make_unique<char[]>(block_size));
+            allocated_bytes_ += block_size;
+            if (block_size > BLOCK_SIZE) {
+                return blocks_.back().get();
+            }
+            current_ = blocks_.back().get();
+            remaining_ = block_size;
+        }
+        char* result = current_;
+        current_ += size;
+        remaining_ -= size;
+        return result;
+    }
+
+}  // namespace string_pool
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace string_pool {
+
+    // Хранит каждую строку один раз в блоках, выделяемых сдвигом указателя.
+    // Выданные string_view действительны, пока жив пул, и освобождаются вместе с ним.
+    class StringPool {
+    public:
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+        StringPool(StringPool&&) = default;
+        StringPool& operator=(StringPool&&) = default;
+
+        std::string_view Intern(std::string_view value);
+
+        size_t GetSize() const;
+        size_t GetAllocatedBytes() const;
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        char* Allocate(size_t size);
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char* current_ = nullptr;
+        size_t remaining_ = 0;
+        size_t allocated_bytes_ = 0;
+        std::unordered_set<std::string_view> interned_;
+    };
+
+}  // namespace string_pool
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+namespace thread_pool {
+
+    ThreadPool::ThreadPool(size_t thread_count) {
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        task_ready_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    size_t ThreadPool::GetDefaultThreadCount() {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 0 ? hardware_threads : 1;
+    }
+
+    void ThreadPool::ParallelFor(size_t task_count, const std::function<void(size_t)>& task) {
+        if (workers_.empty() || task_count <= 1) {
+            for (size_t i = 0; i < task_count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            task_ = &task;
+            task_count_ = task_count;
+            next_task_ = 0;
+            active_workers_ = workers_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        task_ready_.notify_all();
+
+        RunTasks();
+
+        std::unique_lock lock(mutex_);
+        task_done_.wait(lock, [this] { return active_workers_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+    void ThreadPool::WorkerLoop() {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                task_ready_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+
+            RunTasks();
+
+            std::lock_guard lock(mutex_);
+            if (--active_workers_ == 0) {
+                task_done_.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::RunTasks() {
+        for (size_t i = next_task_++; i < task_count_; i = next_task_++) {
+            try {
+                (*task_)(i);
+            }
+            catch (...) {
+                std::lock_guard lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                next_task_ = task_count_;
+            }
+        }
+    }
+
+}  // namespace thread_pool
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace thread_pool {
+
+    // Пул потоков для параллельных фаз предрасчёта.
+    // Вызывающий поток тоже выполняет задачи, поэтому рабочих потоков на один меньше thread_count.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t thread_count);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t GetThreadCount() const;
+
+        // Вызывает task(i) для всех i из [0, task_count) и ждёт завершения.
+        // Первое исключение из задач пробрасывается вызывающему.
+        void ParallelFor(size_t task_count, const std::function<void(size_t)>& task);
+
+        static size_t GetDefaultThreadCount();
+
+    private:
+        void WorkerLoop();
+        void RunTasks();
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable task_ready_;
+        std::condition_variable task_done_;
+        const std::function<void(size_t)>* task_ = nullptr;
+        size_t task_count_ = 0;
+        std::atomic<size_t> next_task_{ 0 };
+        size_t active_workers_ = 0;
+        size_t generation_ = 0;
+        bool stopping_ = false;
+        std::exception_ptr error_;
+    };
+
+}  // namespace thread_pool
@@ -1,77 +1,304 @@
 #include "transport_catalogue.h"
 #include "geo.h"
+#include "thread_pool.h"
 #include <algorithm>
-#include <unordered_set>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <vector>
 #include <stdexcept>
 #include <optional>
 
 namespace transport_catalogue {
 
-    void TransportCatalogue::AddStop(const domain::Stop& stop) {
-        stops_.emplace(stop.name, stop);
-        stop_string_views_.push_back(stops_.at(stop.name).name);
+    namespace {
+
+        constexpr char SNAPSHOT_MAGIC[8] = { 'T', 'C', 'C', 'A', 'T', 'L', 'G', '\0' };
+        constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+        // Файл снимка: заголовок, блок имён, затем массивы каталога в порядке полей класса,
+        // таблица расстояний и готовые BusInfo. Каждая секция выровнена на 8 байт.
+        // Смещения и id проверяются при загрузке, чтобы повреждённый файл не читался за границами.
+        struct SnapshotHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t source_checksum;
+            uint64_t names_size;
+            uint64_t stop_count;
+            uint64_t bus_count;
+            uint64_t bus_stop_count;
+            uint64_t stop_bus_count;
+            uint64_t served_stop_count;
+            uint64_t distance_capacity;
+            uint64_t distance_count;
+        };
+
+        struct SnapshotName {
+            uint64_t offset;
+            uint64_t length;
+        };
+
+        struct SnapshotBusInfo {
+            uint64_t count_stops;
+            uint64_t unique_count_stops;
+            double len;
+            double curvature;
+        };
+
+        // Смещения неубывают, начинаются с нуля и заканчиваются размером массива
+        bool AreOffsetsValid(const size_t* offsets, size_t count, size_t total) {
+            if (offsets[0] != 0 || offsets[count - 1] != total) {
+                return false;
+            }
+            return std::is_sorted(offsets, offsets + count);
+        }
+
+        template <typename Id>
+        bool AreIdsValid(const Id* ids, size_t count, size_t limit) {
+            return std::all_of(ids, ids + count, [limit](Id id) { return id < limit; });
+        }
+
+    }  // namespace
+
+    void TransportCatalogue::Reserve(size_t stop_count, size_t bus_count, size_t bus_stop_count,
+                                     size_t distance_count) {
+        stop_names_.reserve(stop_count);
+        stop_coordinates_.reserve(stop_count);
+        stop_ids_.reserve(stop_count);
+
+        bus_names_.reserve(bus_count);
+        bus_is_circular_.reserve(bus_count);
+        bus_stop_offsets_.reserve(bus_count + 1);
+        bus_ids_.reserve(bus_count);
+        bus_stops_.reserve(bus_stop_count);
+        bus_forward_distances_.reserve(bus_stop_count);
+        bus_backward_distances_.reserve(bus_stop_count);
+
+        distances_.Reserve(distance_count);
     }
 
-    void TransportCatalogue::AddBus(const domain::Bus& bus) {
-        auto& added_bus = buses_.emplace(bus.name, domain::Bus{ bus.name, {}, bus.is_circular }).first->second;
+    domain::StopId TransportCatalogue::AddStop(std::string_view name, geo::Coordinates coordinates) {
+        if (const auto existing = FindStopId(name)) {
+            return *existing;
+        }
+        const auto id = static_cast<domain::StopId>(stop_names_.size());
+        stop_ids_.emplace(stop_names_.emplace_back(names_.Intern(name)), id);
+        stop_coordinates_.push_back(coordinates);
+        return id;
+    }
 
-        for (const auto& stop_name : bus.stops) {
-            const auto& stop_ref = stops_.at(std::string(stop_name));
-            added_bus.stops.push_back(stop_ref.name);
-            buses_by_stop_[stop_ref.name].insert(added_bus.name);
+    domain::BusId TransportCatalogue::AddBus(std::string_view name, StopsRange stops, bool is_circular) {
+        if (const auto existing = FindBusId(name)) {
+            return *existing;
+        }
+        const auto id = static_cast<domain::BusId>(bus_names_.size());
+        const size_t stops_begin = bus_stops_.size();
+        for (const domain::StopId stop : stops) {
+            if (bus_stops_.size() == stops_begin) {
+                bus_forward_distances_.push_back(0);
+                bus_backward_distances_.push_back(0);
+            }
+            else {
+                const domain::StopId prev_stop = bus_stops_.back();
+                bus_forward_distances_.push_back(bus_forward_distances_.back() + GetDistance(prev_stop, stop));
+                bus_backward_distances_.push_back(bus_backward_distances_.back() + GetDistance(stop, prev_stop));
+            }
+            bus_stops_.push_back(stop);
         }
+        bus_stop_offsets_.push_back(bus_stops_.size());
+        bus_ids_.emplace(bus_names_.emplace_back(names_.Intern(name)), id);
+        bus_is_circular_.push_back(is_circular);
+        return id;
     }
 
-    void TransportCatalogue::SetDistance(const std::string_view& from, const std::string_view& to, int distance) {
-        const domain::Stop* from_stop = FindStop(from);
-        const domain::Stop* to_stop = FindStop(to);
-        if (from_stop && to_stop) {
-            distances_[{from_stop, to_stop}] = distance;
+    void TransportCatalogue::SetDistance(domain::StopId from, domain::StopId to, int distance) {
+        distances_.Set(from, to, distance);
+    }
+
+    std::optional<domain::StopId> TransportCatalogue::FindStopId(const std::string_view& name) const {
+        auto it = stop_ids_.find(name);
+        if (it == stop_ids_.end()) {
+            return std::nullopt;
         }
+        return it->second;
     }
 
-    const std::vector<std::string_view>& TransportCatalogue::GetBusStops(const std::string_view& bus_name) const {
-        auto bus_it = buses_.find(std::string(bus_name));
-        if (bus_it != buses_.end()) {
-            return bus_it->second.stops;
+    std::optional<domain::BusId> TransportCatalogue::FindBusId(const std::string_view& name) const {
+        auto it = bus_ids_.find(name);
+        if (it == bus_ids_.end()) {
+            return std::nullopt;
         }
-        else {
-            static const std::vector<std::string_view> empty_result;
-            return empty_result;
+        return it->second;
+    }
+
+    size_t TransportCatalogue::GetStopCount() const {
+        return stop_names_.size();
+    }
+
+    std::string_view TransportCatalogue::GetStopName(domain::StopId stop) const {
+        return stop_names_[stop];
+    }
+
+    const geo::Coordinates& TransportCatalogue::GetStopCoordinates(domain::StopId stop) const {
+        return stop_coordinates_[stop];
+    }
+
+    size_t TransportCatalogue::GetBusCount() const {
+        return bus_names_.size();
+    }
+
+    std::string_view TransportCatalogue::GetBusName(domain::BusId bus) const {
+        return bus_names_[bus];
+    }
+
+    bool TransportCatalogue::IsBusCircular(domain::BusId bus) const {
+        return bus_is_circular_[bus];
+    }
+
+    TransportCatalogue::StopsRange TransportCatalogue::GetBusStops(domain::BusId bus) const {
+        const domain::StopId* data = bus_stops_.data();
+        return { data + bus_stop_offsets_[bus], data + bus_stop_offsets_[bus + 1] };
+    }
+
+    int64_t TransportCatalogue::GetBusDistance(domain::BusId bus, size_t from, size_t to) const {
+        const size_t offset = bus_stop_offsets_[bus];
+        if (from <= to) {
+            return bus_forward_distances_[offset + to] - bus_forward_distances_[offset + from];
         }
+        return bus_backward_distances_[offset + from] - bus_backward_distances_[offset + to];
+    }
+
+    double TransportCatalogue::GetBusGeoDistance(domain::BusId bus, size_t from, size_t to) const {
+        const size_t offset = bus_stop_offsets_[bus];
+        return std::abs(bus_geo_distances_[offset + to] - bus_geo_distances_[offset + from]);
     }
 
-    domain::BusInfo TransportCatalogue::GetBusInfo(const std::string_view& bus_name) const {
-        auto bus_it = buses_.find(std::string(bus_name));
-        if (bus_it == buses_.end()) {
-            throw std::out_of_range("Bus not found");
+    void TransportCatalogue::Finalize(size_t thread_count) {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Автобусы по остановкам раскладываются подсчётом; повтор остановки в одном
+        // автобусе отсекается по последнему учтённому автобусу
+        constexpr auto NO_BUS = static_cast<domain::BusId>(-1);
+        std::vector<domain::BusId> last_buses(GetStopCount(), NO_BUS);
+        stop_bus_offsets_.assign(GetStopCount() + 1, 0);
+        size_t* offsets = stop_bus_offsets_.MutableData();
+        for (domain::BusId bus = 0; bus < GetBusCount(); ++bus) {
+            for (const domain::StopId stop : GetBusStops(bus)) {
+                if (last_buses[stop] != bus) {
+                    last_buses[stop] = bus;
+                    ++offsets[stop + 1];
+                }
+            }
+        }
+        for (domain::StopId stop = 0; stop < GetStopCount(); ++stop) {
+            offsets[stop + 1] += offsets[stop];
+        }
+
+        stop_bus_ids_.resize(stop_bus_offsets_.back());
+        domain::BusId* stop_bus_ids = stop_bus_ids_.MutableData();
+        std::vector<size_t> positions(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+        last_buses.assign(GetStopCount(), NO_BUS);
+        for (domain::BusId bus = 0; bus < GetBusCount(); ++bus) {
+            for (const domain::StopId stop : GetBusStops(bus)) {
+                if (last_buses[stop] != bus) {
+                    last_buses[stop] = bus;
+                    stop_bus_ids[positions[stop]++] = bus;
+                }
+            }
         }
 
-        const auto& bus = bus_it->second;
-        std::unordered_set<std::string_view> unique_stops(bus.stops.begin(), bus.stops.end());
+        served_stops_.clear();
+        for (domain::StopId stop = 0; stop < GetStopCount(); ++stop) {
+            const auto begin = stop_bus_ids + offsets[stop];
+            const auto end = stop_bus_ids + offsets[stop + 1];
+            std::sort(begin, end, [this](domain::BusId lhs, domain::BusId rhs) {
+                return bus_names_[lhs] < bus_names_[rhs];
+            });
+            if (begin != end) {
+                served_stops_.push_back(stop);
+            }
+        }
+
+        stop_index_.Build(stop_coordinates_.data(), stop_coordinates_.size());
+        ComputeGeoDistances();
+
+        bus_infos_.assign(GetBusCount(), domain::BusInfo{});
+        // Потоков не больше, чем автобусов: на маленьком каталоге пул иначе дороже самой работы
+        thread_pool::ThreadPool pool(std::min(thread_count, std::max<size_t>(GetBusCount(), 1)));
+        pool.ParallelFor(GetBusCount(), [this](size_t bus) {
+            bus_infos_[bus] = ComputeBusInfo(static_cast<domain::BusId>(bus));
+        });
+
+        finalization_time_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+
+    void TransportCatalogue::ComputeGeoDistances() {
+        std::vector<geo::UnitVector> stop_vectors;
+        stop_vectors.reserve(GetStopCount());
+        for (const geo::Coordinates& coordinates : stop_coordinates_) {
+            stop_vectors.push_back(geo::ToUnitVector(coordinates));
+        }
+
+        // Одним пакетом по всем соседним парам bus_stops_; пары на стыке двух автобусов
+        // тоже считаются, но в префиксные суммы не попадают
+        std::vector<double> segments(bus_stops_.empty() ? 0 : bus_stops_.size() - 1);
+        geo::ComputeDistances(stop_vectors.data(), bus_stops_.data(), bus_stops_.data() + 1,
+                              segments.data(), segments.size());
+
+        bus_geo_distances_.resize(bus_stops_.size());
+        double* geo_distances = bus_geo_distances_.MutableData();
+        for (domain::BusId bus = 0; bus < GetBusCount(); ++bus) {
+            const size_t begin = bus_stop_offsets_[bus];
+            const size_t end = bus_stop_offsets_[bus + 1];
+            for (size_t position = begin; position < end; ++position) {
+                geo_distances[position] = position == begin
+                    ? 0.0
+                    : geo_distances[position - 1] + segments[position - 1];
+            }
+        }
+    }
+
+    std::chrono::microseconds TransportCatalogue::GetFinalizationTime() const {
+        return finalization_time_;
+    }
+
+    const domain::BusInfo& TransportCatalogue::GetBusInfo(domain::BusId bus) const {
+        if (bus_infos_.size() != GetBusCount()) {
+            throw std::logic_error("Catalogue is not finalized");
+        }
+        return bus_infos_[bus];
+    }
+
+    domain::BusInfo TransportCatalogue::ComputeBusInfo(domain::BusId bus) const {
+        const StopsRange stops = GetBusStops(bus);
+        const size_t stop_count = stops.size();
+        const bool is_circular = IsBusCircular(bus);
+
+        std::vector<domain::StopId> unique_stops(stops.begin(), stops.end());
+        std::sort(unique_stops.begin(), unique_stops.end());
+        unique_stops.erase(std::unique(unique_stops.begin(), unique_stops.end()), unique_stops.end());
+
         double total_length = 0;
         double geo_length = 0;
 
-        for (size_t i = 0; i + 1 < bus.stops.size(); ++i) {
-            const auto& from = stops_.at(std::string(bus.stops[i]));
-            const auto& to = stops_.at(std::string(bus.stops[i + 1]));
-            total_length += GetDistance(bus.stops[i], bus.stops[i + 1]);
-            geo_length += geo::ComputeDistance(from.coordinates, to.coordinates);
-        }
+        if (stop_count > 0) {
+            const size_t last = stop_count - 1;
+            total_length = static_cast<double>(GetBusDistance(bus, 0, last));
+            geo_length = GetBusGeoDistance(bus, 0, last);
 
-        if (!bus.is_circular) {
-            for (size_t i = bus.stops.size() - 1; i > 0; --i) {
-                total_length += GetDistance(bus.stops[i], bus.stops[i - 1]);
+            if (!is_circular) {
+                total_length += static_cast<double>(GetBusDistance(bus, last, 0));
+                geo_length *= 2;
             }
-            geo_length *= 2;
         }
 
         double curvature = geo_length > 0 ? total_length / geo_length : 0;
 
         domain::BusInfo bus_info;
-        bus_info.name = bus.name;
-        bus_info.count_stops = bus.is_circular ? bus.stops.size() : bus.stops.size() * 2 - 1;
+        bus_info.name = std::string(GetBusName(bus));
+        bus_info.count_stops = is_circular ? stop_count : stop_count * 2 - 1;
         bus_info.unique_count_stops = unique_stops.size();
         bus_info.len = total_length;
         bus_info.curvature = curvature;
@@ -79,72 +306,198 @@ namespace transport_catalogue {
         return bus_info;
     }
 
-    std::optional<std::vector<std::string>> TransportCatalogue::GetBusesByStop(const std::string_view& stop_name) const {
-        auto stop_it = stops_.find(std::string(stop_name));
-        if (stop_it == stops_.end()) {
-            return std::nullopt;
-        }
+    TransportCatalogue::BusesRange TransportCatalogue::GetBusesByStop(domain::StopId stop) const {
+        const domain::BusId* data = stop_bus_ids_.data();
+        return { data + stop_bus_offsets_[stop], data + stop_bus_offsets_[stop + 1] };
+    }
 
-        auto buses_it = buses_by_stop_.find(stop_name);
-        if (buses_it == buses_by_stop_.end()) {
-            return std::vector<std::string>{};
-        }
+    int TransportCatalogue::GetDistance(domain::StopId from, domain::StopId to) const {
+        return distances_.Find(from, to).value_or(0);
+    }
 
-        std::vector<std::string> buses(buses_it->second.begin(), buses_it->second.end());
-        std::sort(buses.begin(), buses.end());
-        return buses;
+    TransportCatalogue::StopsRange TransportCatalogue::GetServedStops() const {
+        return { served_stops_.begin(), served_stops_.end() };
     }
 
-    const domain::Stop* TransportCatalogue::FindStop(const std::string_view& name) const {
-        auto it = stops_.find(std::string(name));
-        if (it == stops_.end()) {
-            return nullptr;
-        }
-        return &it->second;
+    bool TransportCatalogue::IsStopServed(domain::StopId stop) const {
+        return stop_bus_offsets_[stop + 1] != stop_bus_offsets_[stop];
     }
 
-    const domain::Bus* TransportCatalogue::FindBus(const std::string_view& name) const {
-        auto it = buses_.find(std::string(name));
-        if (it == buses_.end()) {
-            return nullptr;
-        }
-        return &it->second;
+    std::vector<SpatialIndex::Neighbor> TransportCatalogue::FindNearestStops(geo::Coordinates center, size_t count,
+                                                                            double max_distance) const {
+        return stop_index_.FindNearest(center, count, max_distance);
     }
 
-    int TransportCatalogue::GetDistance(const std::string_view& from, const std::string_view& to) const {
-        const domain::Stop* from_stop = FindStop(from);
-        const domain::Stop* to_stop = FindStop(to);
+    std::vector<domain::StopId> TransportCatalogue::FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+        return stop_index_.FindInBox(min, max);
+    }
 
-        auto it = distances_.find({ from_stop, to_stop });
-        if (it != distances_.end()) {
-            return it->second;
+    void TransportCatalogue::SaveSnapshot(const std::string& path, uint64_t source_checksum) const {
+        if (bus_infos_.size() != GetBusCount()) {
+            throw std::logic_error("Catalogue is not finalized");
         }
 
-        it = distances_.find({ to_stop, from_stop });
-        if (it != distances_.end()) {
-            return it->second;
+        std::string names;
+        auto add_names = [&names](const std::vector<std::string_view>& source) {
+            std::vector<SnapshotName> result;
+            result.reserve(source.size());
+            for (const std::string_view name : source) {
+                result.push_back(SnapshotName{ names.size(), name.size() });
+                names += name;
+            }
+            return result;
+        };
+        const std::vector<SnapshotName> stop_names = add_names(stop_names_);
+        const std::vector<SnapshotName> bus_names = add_names(bus_names_);
+
+        std::vector<SnapshotBusInfo> bus_infos;
+        bus_infos.reserve(bus_infos_.size());
+        for (const domain::BusInfo& bus_info : bus_infos_) {
+            bus_infos.push_back(SnapshotBusInfo{
+                bus_info.count_stops, bus_info.unique_count_stops, bus_info.len, bus_info.curvature });
         }
 
-        return 0;
-    }
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.source_checksum = source_checksum;
+        header.names_size = names.size();
+        header.stop_count = GetStopCount();
+        header.bus_count = GetBusCount();
+        header.bus_stop_count = bus_stops_.size();
+        header.stop_bus_count = stop_bus_ids_.size();
+        header.served_stop_count = served_stops_.size();
+        header.distance_capacity = distances_.GetCapacity();
+        header.distance_count = distances_.GetSize();
 
-    size_t TransportCatalogue::PairHasher::operator()(const std::pair<const domain::Stop*, const domain::Stop*>& pair) const {
-        return std::hash<const void*>()(pair.first) ^ std::hash<const void*>()(pair.second);
+        mapped_file::WriteSnapshotFile(path, [&](mapped_file::SnapshotWriter& writer) {
+            writer.Write(&header, 1);
+            writer.Write(names.data(), names.size());
+            writer.Write(stop_names.data(), stop_names.size());
+            writer.Write(bus_names.data(), bus_names.size());
+            writer.Write(stop_coordinates_.data(), stop_coordinates_.size());
+            writer.Write(stop_bus_offsets_.data(), stop_bus_offsets_.size());
+            writer.Write(stop_bus_ids_.data(), stop_bus_ids_.size());
+            writer.Write(bus_is_circular_.data(), bus_is_circular_.size());
+            writer.Write(bus_stop_offsets_.data(), bus_stop_offsets_.size());
+            writer.Write(bus_stops_.data(), bus_stops_.size());
+            writer.Write(bus_forward_distances_.data(), bus_forward_distances_.size());
+            writer.Write(bus_backward_distances_.data(), bus_backward_distances_.size());
+            writer.Write(bus_geo_distances_.data(), bus_geo_distances_.size());
+            writer.Write(served_stops_.data(), served_stops_.size());
+            writer.Write(distances_.GetSlots(), distances_.GetCapacity());
+            writer.Write(bus_infos.data(), bus_infos.size());
+        });
     }
 
-    const std::unordered_map<std::string, domain::Bus>& TransportCatalogue::GetBuses() const {
-        return buses_;
+    std::optional<TransportCatalogue> TransportCatalogue::LoadSnapshot(const std::string& path) {
+        auto snapshot = std::make_unique<mapped_file::MappedFile>(path);
+        if (!snapshot->IsOpen()) {
+            return std::nullopt;
+        }
+        TransportCatalogue tc;
+        tc.snapshot_ = std::move(snapshot);
+        if (!tc.ReadSnapshot()) {
+            return std::nullopt;
+        }
+        return tc;
     }
 
-    const std::unordered_map<std::string, domain::Stop>& TransportCatalogue::GetStops() const {
-        return filtered_stops_;
-    }
+    bool TransportCatalogue::ReadSnapshot() {
+        mapped_file::SnapshotReader reader(snapshot_->GetData(), snapshot_->GetSize());
+        const auto* header = reader.Read<SnapshotHeader>(1);
+        if (!header
+            || std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+            || header->version != SNAPSHOT_VERSION
+            || header->stop_count > std::numeric_limits<domain::StopId>::max()
+            || header->bus_count > std::numeric_limits<domain::BusId>::max())
+        {
+            return false;
+        }
+
+        const size_t stop_count = header->stop_count;
+        const size_t bus_count = header->bus_count;
+        const size_t bus_stop_count = header->bus_stop_count;
+        const size_t stop_bus_count = header->stop_bus_count;
+        const size_t served_stop_count = header->served_stop_count;
+
+        const auto* names = reader.Read<char>(header->names_size);
+        const auto* stop_names = reader.Read<SnapshotName>(stop_count);
+        const auto* bus_names = reader.Read<SnapshotName>(bus_count);
+        const auto* stop_coordinates = reader.Read<geo::Coordinates>(stop_count);
+        const auto* stop_bus_offsets = reader.Read<size_t>(stop_count + 1);
+        const auto* stop_bus_ids = reader.Read<domain::BusId>(stop_bus_count);
+        const auto* bus_is_circular = reader.Read<uint8_t>(bus_count);
+        const auto* bus_stop_offsets = reader.Read<size_t>(bus_count + 1);
+        const auto* bus_stops = reader.Read<domain::StopId>(bus_stop_count);
+        const auto* bus_forward_distances = reader.Read<int64_t>(bus_stop_count);
+        const auto* bus_backward_distances = reader.Read<int64_t>(bus_stop_count);
+        const auto* bus_geo_distances = reader.Read<double>(bus_stop_count);
+        const auto* served_stops = reader.Read<domain::StopId>(served_stop_count);
+        const auto* distance_slots = reader.Read<DistanceIndex::Slot>(header->distance_capacity);
+        const auto* bus_infos = reader.Read<SnapshotBusInfo>(bus_count);
+        if (!names || !stop_names || !bus_names || !stop_coordinates || !stop_bus_offsets || !stop_bus_ids
+            || !bus_is_circular || !bus_stop_offsets || !bus_stops || !bus_forward_distances
+            || !bus_backward_distances || !bus_geo_distances || !served_stops || !distance_slots || !bus_infos)
+        {
+            return false;
+        }
+
+        auto is_name_valid = [header](const SnapshotName& name) {
+            return name.offset <= header->names_size && name.length <= header->names_size - name.offset;
+        };
+        if (!std::all_of(stop_names, stop_names + stop_count, is_name_valid)
+            || !std::all_of(bus_names, bus_names + bus_count, is_name_valid)
+            || !AreOffsetsValid(stop_bus_offsets, stop_count + 1, stop_bus_count)
+            || !AreOffsetsValid(bus_stop_offsets, bus_count + 1, bus_stop_count)
+            || !AreIdsValid(stop_bus_ids, stop_bus_count, bus_count)
+            || !AreIdsValid(bus_stops, bus_stop_count, stop_count)
+            || !AreIdsValid(served_stops, served_stop_count, stop_count)
+            || !distances_.Attach(distance_slots, header->distance_capacity, header->distance_count))
+        {
+            return false;
+        }
 
-    void TransportCatalogue::UpdateFilteredStops(const std::unordered_set<std::string>& stops_in_routes) {
-        filtered_stops_.clear();
-        for (const auto& stop_name : stops_in_routes) {
-            filtered_stops_.emplace(stop_name, stops_.at(stop_name));
+        // Массивы читаются прямо из файла; в памяти строятся только string_view имён и индексы по ним
+        stop_names_.reserve(stop_count);
+        stop_ids_.reserve(stop_count);
+        for (domain::StopId stop = 0; stop < stop_count; ++stop) {
+            const std::string_view name(names + stop_names[stop].offset, stop_names[stop].length);
+            stop_ids_.emplace(stop_names_.emplace_back(name), stop);
         }
+        bus_names_.reserve(bus_count);
+        bus_ids_.reserve(bus_count);
+        bus_infos_.reserve(bus_count);
+        for (domain::BusId bus = 0; bus < bus_count; ++bus) {
+            const std::string_view name(names + bus_names[bus].offset, bus_names[bus].length);
+            bus_ids_.emplace(bus_names_.emplace_back(name), bus);
+
+            domain::BusInfo& bus_info = bus_infos_.emplace_back();
+            bus_info.name = std::string(name);
+            bus_info.count_stops = bus_infos[bus].count_stops;
+            bus_info.unique_count_stops = bus_infos[bus].unique_count_stops;
+            bus_info.len = bus_infos[bus].len;
+            bus_info.curvature = bus_infos[bus].curvature;
+        }
+
+        stop_coordinates_.Attach(stop_coordinates, stop_count);
+        stop_bus_offsets_.Attach(stop_bus_offsets, stop_count + 1);
+        stop_bus_ids_.Attach(stop_bus_ids, stop_bus_count);
+        bus_is_circular_.Attach(bus_is_circular, bus_count);
+        bus_stop_offsets_.Attach(bus_stop_offsets, bus_count + 1);
+        bus_stops_.Attach(bus_stops, bus_stop_count);
+        bus_forward_distances_.Attach(bus_forward_distances, bus_stop_count);
+        bus_backward_distances_.Attach(bus_backward_distances, bus_stop_count);
+        bus_geo_distances_.Attach(bus_geo_distances, bus_stop_count);
+        served_stops_.Attach(served_stops, served_stop_count);
+        // Сетка не хранится в снимке: её построение линейно и не дороже чтения имён
+        stop_index_.Build(stop_coordinates, stop_count);
+        source_checksum_ = header->source_checksum;
+        return true;
+    }
+
+    std::optional<uint64_t> TransportCatalogue::GetSourceChecksum() const {
+        return source_checksum_;
     }
 
 }  // namespace transport_catalogue
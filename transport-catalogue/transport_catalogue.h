@@ -1,44 +1,132 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <unordered_set>
 #include <string_view>
 #include <optional>
+#include "distance_index.h"
 #include "domain.h"
+#include "mapped_array.h"
+#include "mapped_file.h"
+#include "ranges.h"
+#include "spatial_index.h"
+#include "string_pool.h"
 
 namespace transport_catalogue {
 
+    class CatalogueBuilder;
+
+    // Остановки и автобусы лежат в параллельных массивах и адресуются плотными id.
+    // Поиск по имени нужен только на границе API — в FindStopId и FindBusId.
+    // Заполняется только через CatalogueBuilder и после построения не меняется.
+    // Готовый каталог сохраняется в двоичный снимок; загруженный из снимка каталог читает
+    // массивы прямо из отображённого файла, а в памяти заново строит только индексы имён.
     class TransportCatalogue {
     public:
-        void AddStop(const domain::Stop& stop);
-        void AddBus(const domain::Bus& bus);
-        void SetDistance(const std::string_view& from, const std::string_view& to, int distance);
+        using StopsRange = ranges::Range<const domain::StopId*>;
+        using BusesRange = ranges::Range<const domain::BusId*>;
+
+        std::optional<domain::StopId> FindStopId(const std::string_view& name) const;
+        std::optional<domain::BusId> FindBusId(const std::string_view& name) const;
+
+        size_t GetStopCount() const;
+        std::string_view GetStopName(domain::StopId stop) const;
+        const geo::Coordinates& GetStopCoordinates(domain::StopId stop) const;
+
+        size_t GetBusCount() const;
+        std::string_view GetBusName(domain::BusId bus) const;
+        bool IsBusCircular(domain::BusId bus) const;
+        StopsRange GetBusStops(domain::BusId bus) const;
+        // Дорожное расстояние вдоль автобуса между позициями его остановок за O(1);
+        // при from > to автобус едет в обратную сторону, и берутся расстояния обратного хода
+        int64_t GetBusDistance(domain::BusId bus, size_t from, size_t to) const;
+        double GetBusGeoDistance(domain::BusId bus, size_t from, size_t to) const;
 
-        const domain::Stop* FindStop(const std::string_view& name) const;
-        const domain::Bus* FindBus(const std::string_view& name) const;
-        const std::vector<std::string_view>& GetBusStops(const std::string_view& bus_name) const;
-        domain::BusInfo GetBusInfo(const std::string_view& bus_name) const;
-        std::optional<std::vector<std::string>> GetBusesByStop(const std::string_view& stop_name) const;
-        int GetDistance(const std::string_view& from, const std::string_view& to) const;
+        // Сколько заняла финализация при построении; у каталога из снимка — ноль
+        std::chrono::microseconds GetFinalizationTime() const;
 
-        const std::unordered_map<std::string, domain::Bus>& GetBuses() const;
-        const std::unordered_map<std::string, domain::Stop>& GetStops() const;
-        void UpdateFilteredStops(const std::unordered_set<std::string>& stops_in_routes);
+        // Готовые сведения из Finalize; до финализации бросает std::logic_error
+        const domain::BusInfo& GetBusInfo(domain::BusId bus) const;
+        // Автобусы через остановку, упорядоченные по имени; список готовит Finalize
+        BusesRange GetBusesByStop(domain::StopId stop) const;
+        int GetDistance(domain::StopId from, domain::StopId to) const;
 
+        // Остановки, через которые проходит хотя бы один автобус, по возрастанию id.
+        // Список собирается в Finalize и ссылается на основное хранилище остановок.
+        StopsRange GetServedStops() const;
+        bool IsStopServed(domain::StopId stop) const;
+
+        // До count ближайших к center остановок не дальше max_distance метров, по возрастанию
+        // расстояния. Сетку по координатам остановок строит Finalize.
+        std::vector<SpatialIndex::Neighbor> FindNearestStops(geo::Coordinates center, size_t count,
+                                                             double max_distance) const;
+        // Остановки в прямоугольнике между углами min и max по возрастанию id
+        std::vector<domain::StopId> FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+
+        // Пишет финализированный каталог в файл path; source_checksum — контрольная сумма
+        // входных данных, из которых он построен. Ошибки записи бросают std::runtime_error.
+        void SaveSnapshot(const std::string& path, uint64_t source_checksum) const;
+        // nullopt, если файла нет, он другой версии или повреждён
+        static std::optional<TransportCatalogue> LoadSnapshot(const std::string& path);
+        // Контрольная сумма из снимка; у каталога, построенного в памяти, её нет
+        std::optional<uint64_t> GetSourceChecksum() const;
 
     private:
-        struct PairHasher {
-            size_t operator()(const std::pair<const domain::Stop*, const domain::Stop*>& pair) const;
-        };
-
-        std::unordered_map<std::string, domain::Stop> stops_;
-        std::unordered_map<std::string, domain::Bus> buses_;
-        std::unordered_map<std::string_view, std::unordered_set<std::string>> buses_by_stop_;
-        std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, PairHasher> distances_;
-        std::vector<std::string_view> stop_string_views_;
-        std::unordered_map<std::string, domain::Stop> filtered_stops_;
+        friend class CatalogueBuilder;
+
+        void Reserve(size_t stop_count, size_t bus_count, size_t bus_stop_count, size_t distance_count);
+        domain::StopId AddStop(std::string_view name, geo::Coordinates coordinates);
+        // Расстояния между остановками автобуса берутся в момент добавления,
+        // поэтому SetDistance нужно вызвать до AddBus
+        domain::BusId AddBus(std::string_view name, StopsRange stops, bool is_circular);
+        void SetDistance(domain::StopId from, domain::StopId to, int distance);
+
+        // Считает BusInfo всех автобусов параллельно на thread_count потоках,
+        // раскладывает автобусы по остановкам, собирает список обслуживаемых остановок,
+        // строит сетку по их координатам и считает расстояния по прямой вдоль автобусов.
+        // Вызывается один раз, когда все остановки, расстояния и автобусы уже добавлены.
+        void Finalize(size_t thread_count);
+        domain::BusInfo ComputeBusInfo(domain::BusId bus) const;
+        // Префиксные суммы расстояний по прямой — пакетным ядром geo::ComputeDistances
+        void ComputeGeoDistances();
+        bool ReadSnapshot();
+
+        // Все имена лежат в пуле или в снимке; остальные структуры хранят только string_view на них
+        string_pool::StringPool names_;
+
+        std::vector<std::string_view> stop_names_;
+        mapped_file::MappedArray<geo::Coordinates> stop_coordinates_;
+        std::unordered_map<std::string_view, domain::StopId> stop_ids_;
+        // Автобусы остановки stop по имени — stop_bus_ids_[stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1])
+        mapped_file::MappedArray<size_t> stop_bus_offsets_;
+        mapped_file::MappedArray<domain::BusId> stop_bus_ids_;
+
+        std::vector<std::string_view> bus_names_;
+        mapped_file::MappedArray<uint8_t> bus_is_circular_;
+        // Остановки автобуса bus — bus_stops_[bus_stop_offsets_[bus], bus_stop_offsets_[bus + 1])
+        mapped_file::MappedArray<size_t> bus_stop_offsets_ = { 0 };
+        mapped_file::MappedArray<domain::StopId> bus_stops_;
+        // Префиксные суммы с теми же смещениями, что у bus_stops_: дорога вперёд,
+        // дорога назад (от позиции k + 1 к k) и расстояние по прямой, которое досчитывает Finalize
+        mapped_file::MappedArray<int64_t> bus_forward_distances_;
+        mapped_file::MappedArray<int64_t> bus_backward_distances_;
+        mapped_file::MappedArray<double> bus_geo_distances_;
+        std::unordered_map<std::string_view, domain::BusId> bus_ids_;
+
+        DistanceIndex distances_;
+        mapped_file::MappedArray<domain::StopId> served_stops_;
+        SpatialIndex stop_index_;
+
+        std::vector<domain::BusInfo> bus_infos_;
+        std::chrono::microseconds finalization_time_{ 0 };
+
+        // Снимок, из которого загружен каталог: на него указывают массивы и имена выше
+        std::unique_ptr<mapped_file::MappedFile> snapshot_;
+        std::optional<uint64_t> source_checksum_;
     };
 
 }  // namespace transport_catalogue
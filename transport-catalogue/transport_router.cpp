@@ -1,91 +1,345 @@
 #include "transport_router.h"
+#include "mapped_file.h"
+#include "raptor_router.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace router {
 
+    namespace {
+
+        constexpr char SNAPSHOT_MAGIC[8] = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0' };
+        constexpr uint32_t SNAPSHOT_VERSION = 4;
+        constexpr graph::VertexId NO_VERTEX = std::numeric_limits<graph::VertexId>::max();
+        // Запас в метрах к расстоянию по прямой при подсчёте отношения для A*. Погрешность acos
+        // в ComputeDistance около 0.15 м на расстояние, а в доказательстве согласованности
+        // участвуют три расстояния
+        constexpr double GEO_DISTANCE_SLACK = 1.0;
+
+        // Файл снимка: заголовок, вершины остановок каталога, остановки вершин и их векторы,
+        // массивы CSR-графа, описания рёбер и, если есть, матрицы FlatRouter. Каждая секция
+        // выровнена на 8 байт. Id остановок и автобусов совпадают с каталогом, потому что
+        // контрольная сумма фиксирует входные данные.
+        struct SnapshotHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t has_route_tables;
+            uint64_t checksum;
+            uint64_t catalogue_stop_count;
+            uint64_t stop_count;
+            uint64_t edge_count;
+            double min_road_to_geo_ratio;
+        };
+
+    }  // namespace
+
     TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings)
         : tc_(tc), settings_(settings) {
         BuildRouter();
     }
 
+    TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings,
+                                     std::unique_ptr<mapped_file::MappedFile> snapshot)
+        : tc_(tc), settings_(settings), snapshot_(std::move(snapshot)) {
+    }
+
+    TransportRouter::~TransportRouter() = default;
+
+    std::unique_ptr<TransportRouter> TransportRouter::LoadSnapshot(const transport_catalogue::TransportCatalogue& tc,
+                                                                   const RoutingSettings& settings,
+                                                                   const std::string& path, uint64_t checksum) {
+        if (settings.engine == RouterEngine::Raptor) {
+            return nullptr;
+        }
+        auto snapshot = std::make_unique<mapped_file::MappedFile>(path);
+        if (!snapshot->IsOpen()) {
+            return nullptr;
+        }
+        std::unique_ptr<TransportRouter> router(new TransportRouter(tc, settings, std::move(snapshot)));
+        if (!router->ReadSnapshot(checksum)) {
+            return nullptr;
+        }
+        return router;
+    }
+
+    bool TransportRouter::ReadSnapshot(uint64_t checksum) {
+        mapped_file::SnapshotReader reader(snapshot_->GetData(), snapshot_->GetSize());
+        const auto* header = reader.Read<SnapshotHeader>(1);
+        if (!header
+            || std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+            || header->version != SNAPSHOT_VERSION
+            || header->checksum != checksum
+            || header->catalogue_stop_count != tc_.GetStopCount()
+            || header->stop_count > header->catalogue_stop_count
+            // Отношение входит в эвристику A*: NaN, отрицательное или бесконечное сделало бы её неверной
+            || !std::isfinite(header->min_road_to_geo_ratio)
+            || header->min_road_to_geo_ratio < 0.0)
+        {
+            return false;
+        }
+
+        const size_t vertex_count = header->stop_count * 2;
+        const auto* stop_vertex_ids = reader.Read<graph::VertexId>(header->catalogue_stop_count);
+        const auto* vertex_stops = reader.Read<domain::StopId>(header->stop_count);
+        const auto* stop_vectors = reader.Read<geo::UnitVector>(header->stop_count);
+        const auto* edges = reader.Read<graph::Edge<double>>(header->edge_count);
+        const auto* offsets = reader.Read<size_t>(vertex_count + 1);
+        const auto* incident_edges = reader.Read<graph::EdgeId>(header->edge_count);
+        const auto* incoming_offsets = reader.Read<size_t>(vertex_count + 1);
+        const auto* incoming_edges = reader.Read<graph::EdgeId>(header->edge_count);
+        const auto* edge_infos = reader.Read<EdgeInfo>(header->edge_count);
+        if (!stop_vertex_ids || !vertex_stops || !stop_vectors || !edges || !offsets || !incident_edges
+            || !incoming_offsets || !incoming_edges || !edge_infos)
+        {
+            return false;
+        }
+
+        // Остановка вершины i ссылается обратно на вершину 2i, прочие остановки вершин не имеют
+        for (size_t i = 0; i < header->stop_count; ++i) {
+            if (vertex_stops[i] >= header->catalogue_stop_count || stop_vertex_ids[vertex_stops[i]] != i * 2) {
+                return false;
+            }
+        }
+        for (size_t stop = 0; stop < header->catalogue_stop_count; ++stop) {
+            if (stop_vertex_ids[stop] != NO_VERTEX && stop_vertex_ids[stop] >= vertex_count) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < header->edge_count; ++i) {
+            if (edge_infos[i].bus != NO_BUS && edge_infos[i].bus >= tc_.GetBusCount()) {
+                return false;
+            }
+        }
+
+        auto graph = std::make_unique<graph::CsrGraph<double>>();
+        if (!graph->Attach({ vertex_count, header->edge_count, edges, offsets, incident_edges,
+                             incoming_offsets, incoming_edges }))
+        {
+            return false;
+        }
+        graph_ = std::move(graph);
+        stop_vertex_ids_.Attach(stop_vertex_ids, header->catalogue_stop_count);
+        vertex_stops_.Attach(vertex_stops, header->stop_count);
+        stop_vectors_.Attach(stop_vectors, header->stop_count);
+        edge_infos_.Attach(edge_infos, header->edge_count);
+        min_road_to_geo_ratio_ = header->min_road_to_geo_ratio;
+
+        if (header->has_route_tables && settings_.engine == RouterEngine::AllPairsFlat) {
+            using FlatRouter = graph::FlatRouter<double>;
+            const size_t cell_count = vertex_count * vertex_count;
+            const auto* weights = reader.Read<FlatRouter::CompactWeight>(cell_count);
+            const auto* prev_edges = reader.Read<FlatRouter::CompactEdgeId>(cell_count);
+            if (!weights || !prev_edges) {
+                return false;
+            }
+            auto router = std::make_unique<FlatRouter>(*graph_, weights, prev_edges);
+            if (!router->HasValidTables()) {
+                return false;
+            }
+            router_ = std::move(router);
+        }
+        else {
+            CreateRouter();
+        }
+        return true;
+    }
+
+    void TransportRouter::SaveSnapshot(const std::string& path, uint64_t checksum) const {
+        if (!graph_) {
+            return;
+        }
+
+        const auto arrays = graph_->GetArrays();
+        const auto* flat_router = dynamic_cast<const graph::FlatRouter<double>*>(router_.get());
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.has_route_tables = flat_router != nullptr;
+        header.checksum = checksum;
+        header.catalogue_stop_count = stop_vertex_ids_.size();
+        header.stop_count = vertex_stops_.size();
+        header.edge_count = arrays.edge_count;
+        header.min_road_to_geo_ratio = min_road_to_geo_ratio_;
+
+        mapped_file::WriteSnapshotFile(path, [&](mapped_file::SnapshotWriter& writer) {
+            writer.Write(&header, 1);
+            writer.Write(stop_vertex_ids_.data(), stop_vertex_ids_.size());
+            writer.Write(vertex_stops_.data(), vertex_stops_.size());
+            writer.Write(stop_vectors_.data(), stop_vectors_.size());
+            writer.Write(arrays.edges, arrays.edge_count);
+            writer.Write(arrays.offsets, arrays.vertex_count + 1);
+            writer.Write(arrays.incident_edges, arrays.edge_count);
+            writer.Write(arrays.incoming_offsets, arrays.vertex_count + 1);
+            writer.Write(arrays.incoming_edges, arrays.edge_count);
+            writer.Write(edge_infos_.data(), edge_infos_.size());
+            if (flat_router) {
+                const size_t cell_count = arrays.vertex_count * arrays.vertex_count;
+                writer.Write(flat_router->GetWeights(), cell_count);
+                writer.Write(flat_router->GetPrevEdges(), cell_count);
+            }
+        });
+    }
+
     void TransportRouter::BuildRouter() {
+        // RAPTOR работает прямо по остановкам автобусов, граф ему не нужен
+        if (settings_.engine == RouterEngine::Raptor) {
+            raptor_router_ = std::make_unique<RaptorRouter>(tc_, settings_);
+            return;
+        }
+
         InitializeVertexIds();
-        AddWaitEdges();
-        AddBusEdges();
-        router_ = std::make_unique<graph::Router<double>>(*graph_);
+
+        // Рёбра добавляются в изменяемый граф, а все движки работают по замороженной CSR-копии
+        graph::DirectedWeightedGraph<double> graph(vertex_stops_.size() * 2);
+        AddWaitEdges(graph);
+        AddBusEdges(graph);
+        graph_ = std::make_unique<graph::CsrGraph<double>>(graph);
+
+        CreateRouter();
     }
 
-    void TransportRouter::InitializeVertexIds() {
-        const auto& stops = tc_.GetStops();
-        graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(stops.size() * 2);
+    void TransportRouter::CreateRouter() {
+        switch (settings_.engine) {
+        case RouterEngine::AllPairs:
+            router_ = std::make_unique<graph::Router<double>>(*graph_);
+            break;
+        case RouterEngine::AllPairsFlat:
+            router_ = std::make_unique<graph::FlatRouter<double>>(*graph_, settings_.thread_count);
+            break;
+        case RouterEngine::Dijkstra:
+            router_ = std::make_unique<graph::DijkstraRouter<double>>(*graph_);
+            break;
+        case RouterEngine::ContractionHierarchies:
+            router_ = std::make_unique<graph::ContractionHierarchyRouter<double>>(*graph_);
+            break;
+        case RouterEngine::Raptor:
+            break;
+        case RouterEngine::AStar:
+            router_ = std::make_unique<graph::DijkstraRouter<double>>(*graph_,
+                [this](graph::VertexId vertex, graph::VertexId target) {
+                    return GetTravelTimeLowerBound(vertex, target);
+                });
+            break;
+        case RouterEngine::BidirectionalDijkstra:
+            router_ = std::make_unique<graph::BidirectionalDijkstraRouter<double>>(*graph_);
+            break;
+        }
+    }
 
+    void TransportRouter::InitializeVertexIds() {
+        stop_vertex_ids_.assign(tc_.GetStopCount(), NO_VERTEX);
         graph::VertexId vertex_id = 0;
-        for (const auto& [stop_name, stop] : stops) {
-            stop_to_vertex_id_[stop_name] = vertex_id;
-            vertex_id_to_stop_name_[vertex_id] = stop_name;
+        for (const domain::StopId stop : tc_.GetServedStops()) {
+            stop_vertex_ids_.MutableData()[stop] = vertex_id;
+            vertex_stops_.push_back(stop);
+            stop_vectors_.push_back(geo::ToUnitVector(tc_.GetStopCoordinates(stop)));
             vertex_id += 2;
         }
     }
 
-    void TransportRouter::AddWaitEdges() {
-        for (const auto& [stop_name, _] : tc_.GetStops()) {
-            graph::EdgeId edge_id = graph_->AddEdge({
-                stop_to_vertex_id_[stop_name],
-                stop_to_vertex_id_[stop_name] + 1,
+    void TransportRouter::AddWaitEdges(graph::DirectedWeightedGraph<double>& graph) {
+        for (const domain::StopId stop : vertex_stops_) {
+            graph.AddEdge({
+                stop_vertex_ids_[stop],
+                stop_vertex_ids_[stop] + 1,
                 static_cast<double>(settings_.bus_wait_time.count())
                 });
-            edge_id_to_info_[edge_id] = EdgeInfo{ "", 0 };
+            edge_infos_.push_back(EdgeInfo{ NO_BUS, 0 });
         }
     }
 
-    void TransportRouter::AddBusEdges() {
-        for (const auto& [bus_name, bus] : tc_.GetBuses()) {
-            const auto& stops = bus.stops;
+    void TransportRouter::AddBusEdges(graph::DirectedWeightedGraph<double>& graph) {
+        min_road_to_geo_ratio_ = std::numeric_limits<double>::infinity();
+        const double bus_velocity_m_per_min = settings_.bus_velocity * 1000.0 / 60.0;
 
-            if (stops.size() < 2) {
+        for (domain::BusId bus = 0; bus < tc_.GetBusCount(); ++bus) {
+            const auto stops = tc_.GetBusStops(bus);
+            const size_t stop_count = stops.size();
+
+            if (stop_count < 2) {
                 continue;
             }
 
-            auto AddEdgesBetweenStops = [&](const std::vector<std::string_view>& stop_sequence) {
-                for (size_t i = 0; i + 1 < stop_sequence.size(); ++i) {
-                    double total_distance = 0.0;
-                    size_t span_count = 0;
+            // Расстояние между любыми двумя позициями — разность префиксных сумм каталога
+            auto AddEdgesBetweenStops = [&](bool is_reverse) {
+                auto get_position = [&](size_t index) {
+                    return is_reverse ? stop_count - 1 - index : index;
+                };
+
+                for (size_t i = 0; i + 1 < stop_count; ++i) {
+                    const size_t from_position = get_position(i);
+                    const domain::StopId from_stop = stops.begin()[from_position];
 
-                    for (size_t j = i + 1; j < stop_sequence.size(); ++j) {
-                        const auto from_stop = stop_sequence[j - 1];
-                        const auto to_stop = stop_sequence[j];
+                    for (size_t j = i + 1; j < stop_count; ++j) {
+                        const size_t to_position = get_position(j);
+                        const domain::StopId to_stop = stops.begin()[to_position];
+                        const size_t span_count = j - i;
 
-                        total_distance += tc_.GetDistance(from_stop, to_stop);
-                        ++span_count;
+                        const int64_t distance = tc_.GetBusDistance(bus, from_position, to_position);
+                        if (span_count == 1) {
+                            UpdateRoadToGeoRatio(tc_.GetBusGeoDistance(bus, from_position, to_position), distance);
+                        }
 
-                        double bus_velocity_m_per_min = settings_.bus_velocity * 1000.0 / 60.0;
-                        double travel_time = total_distance / bus_velocity_m_per_min;
+                        double travel_time = static_cast<double>(distance) / bus_velocity_m_per_min;
 
-                        graph::EdgeId edge_id = graph_->AddEdge({
-                            stop_to_vertex_id_[stop_sequence[i]] + 1,
-                            stop_to_vertex_id_[stop_sequence[j]],
+                        graph.AddEdge({
+                            stop_vertex_ids_[from_stop] + 1,
+                            stop_vertex_ids_[to_stop],
                             travel_time
                             });
 
-                        edge_id_to_info_[edge_id] = EdgeInfo{ bus_name, span_count };
+                        edge_infos_.push_back(EdgeInfo{ bus, static_cast<uint32_t>(span_count) });
                     }
                 }
                 };
 
-            AddEdgesBetweenStops(stops);
+            AddEdgesBetweenStops(false);
 
-            if (!bus.is_circular) {
-                std::vector<std::string_view> reverse_stops(stops.rbegin(), stops.rend());
-                AddEdgesBetweenStops(reverse_stops);
+            if (!tc_.IsBusCircular(bus)) {
+                AddEdgesBetweenStops(true);
             }
         }
+
+        if (min_road_to_geo_ratio_ == std::numeric_limits<double>::infinity()) {
+            min_road_to_geo_ratio_ = 0.0;
+        }
+    }
+
+    // Учитываются все перегоны, в том числе между совпадающими остановками: запас в знаменателе
+    // покрывает погрешность вычисленных расстояний, поэтому отношение не завышается
+    void TransportRouter::UpdateRoadToGeoRatio(double geo_distance, int64_t road_distance) {
+        min_road_to_geo_ratio_ = std::min(min_road_to_geo_ratio_,
+                                          static_cast<double>(road_distance) / (geo_distance + GEO_DISTANCE_SLACK));
+    }
+
+    // Путь до другой остановки проходит по перегонам, каждый из которых по дороге не короче
+    // min_road_to_geo_ratio_ расстояний по прямой, а из вершины прибытия нужно ещё дождаться автобуса.
+    // Оценка согласованная: на ребре ожидания она падает ровно на его вес, на ребре автобуса —
+    // не больше чем на его вес по неравенству треугольника. Погрешность вычисленных расстояний
+    // учтена в отношении, а DijkstraRouter не раскрывает вершины повторно, поэтому согласованность
+    // должна выполняться и с ошибками округления.
+    double TransportRouter::GetTravelTimeLowerBound(graph::VertexId vertex, graph::VertexId target) const {
+        const size_t stop = vertex / 2;
+        const size_t target_stop = target / 2;
+        if (stop == target_stop) {
+            return 0.0;
+        }
+
+        const double distance = geo::ComputeDistance(stop_vectors_[stop], stop_vectors_[target_stop])
+            * min_road_to_geo_ratio_;
+        const double bus_velocity_m_per_min = settings_.bus_velocity * 1000.0 / 60.0;
+        const double wait_time = vertex % 2 == 0 ? static_cast<double>(settings_.bus_wait_time.count()) : 0.0;
+        return wait_time + distance / bus_velocity_m_per_min;
     }
 
-    std::optional<graph::VertexId> TransportRouter::GetStopVertexId(const std::string_view& stop_name) const {
-        auto it = stop_to_vertex_id_.find(stop_name);
-        if (it != stop_to_vertex_id_.end()) {
-            return it->second;
+    std::optional<graph::VertexId> TransportRouter::GetStopVertexId(domain::StopId stop) const {
+        if (stop < stop_vertex_ids_.size() && stop_vertex_ids_[stop] != NO_VERTEX) {
+            return stop_vertex_ids_[stop];
         }
         else {
             return std::nullopt;
@@ -93,21 +347,18 @@ namespace router {
     }
 
     const EdgeInfo& TransportRouter::GetEdgeInfo(graph::EdgeId edge_id) const {
-        return edge_id_to_info_.at(edge_id);
+        return edge_infos_[edge_id];
     }
 
-    std::string_view TransportRouter::GetStopNameByVertexId(graph::VertexId vertex_id) const {
-        vertex_id = vertex_id % 2 == 0 ? vertex_id : vertex_id - 1;
-        auto it = vertex_id_to_stop_name_.find(vertex_id);
-        if (it != vertex_id_to_stop_name_.end()) {
-            return it->second;
-        }
-        else {
-            return "";
-        }
+    domain::StopId TransportRouter::GetStopByVertexId(graph::VertexId vertex_id) const {
+        return vertex_stops_[vertex_id / 2];
     }
 
-    std::optional<RouteInfo> TransportRouter::FindOptimalRoute(const std::string& from, const std::string& to) const {
+    std::optional<RouteInfo> TransportRouter::FindOptimalRoute(domain::StopId from, domain::StopId to) const {
+        if (raptor_router_) {
+            return raptor_router_->FindRoute(from, to);
+        }
+
         auto from_vertex_opt = GetStopVertexId(from);
         auto to_vertex_opt = GetStopVertexId(to);
 
@@ -126,16 +377,16 @@ namespace router {
 
         RouteInfo route_info;
         route_info.total_time = route_result->weight;
+        route_info.settled_vertices = route_result->settled_vertices;
 
         for (const auto& edge_id : route_result->edges) {
             const auto& edge = graph_->GetEdge(edge_id);
             const auto& edge_info = GetEdgeInfo(edge_id);
 
-            if (edge_info.bus_name.empty()) {
-                std::string_view stop_name = GetStopNameByVertexId(edge.from);
+            if (edge_info.bus == NO_BUS) {
                 route_info.items.push_back(RouteItem{
                     RouteItem::Type::Wait,
-                    std::string(stop_name),
+                    std::string(tc_.GetStopName(GetStopByVertexId(edge.from))),
                     "",
                     edge.weight,
                     0
@@ -145,7 +396,7 @@ namespace router {
                 route_info.items.push_back(RouteItem{
                     RouteItem::Type::Bus,
                     "",
-                    edge_info.bus_name,
+                    std::string(tc_.GetBusName(edge_info.bus)),
                     edge.weight,
                     edge_info.span_count
                     });
@@ -1,27 +1,56 @@
 #pragma once
 
+#include "geo.h"
 #include "graph.h"
+#include "mapped_array.h"
 #include "transport_catalogue.h"
 #include "router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
+#include "flat_router.h"
 
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
-#include <string_view>
-#include <unordered_map>
 #include <vector>
 
+namespace mapped_file {
+    class MappedFile;
+}
+
 namespace router {
 
+    enum class RouterEngine {
+        AllPairs,
+        AllPairsFlat,
+        Dijkstra,
+        ContractionHierarchies,
+        Raptor,
+        AStar,
+        BidirectionalDijkstra
+    };
+
     struct RoutingSettings {
         std::chrono::minutes bus_wait_time;
         double bus_velocity;
+        // Снимок маршрутизатора хранит граф, а таблицы маршрутов — только для all_pairs_flat.
+        // Остальные движки после загрузки снимка готовят свои структуры заново,
+        // all_pairs — тем же Флойдом — Уоршеллом за O(V³)
+        RouterEngine engine = RouterEngine::AllPairs;
+        size_t thread_count = 1;
     };
 
+    inline constexpr domain::BusId NO_BUS = std::numeric_limits<domain::BusId>::max();
+
+    // Плоская запись, чтобы описания рёбер отображались из снимка как есть.
+    // У рёбер ожидания автобуса нет: bus == NO_BUS
     struct EdgeInfo {
-        std::string bus_name;
-        size_t span_count;
+        domain::BusId bus;
+        uint32_t span_count;
     };
 
     struct RouteItem {
@@ -40,31 +69,63 @@ namespace router {
     struct RouteInfo {
         double total_time;
         std::vector<RouteItem> items;
+        // Сколько вершин графа обработал поиск; есть только у движков с поиском на каждый запрос
+        std::optional<size_t> settled_vertices = std::nullopt;
     };
 
+    class RaptorRouter;
+
     class TransportRouter {
     public:
         TransportRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings);
+        ~TransportRouter();
+
+        // Снимок — двоичный файл с вершинами остановок, массивами CSR-графа и описаниями рёбер, а для
+        // all_pairs_flat ещё и с матрицами маршрутов. Загрузка отображает файл в память и только проверяет
+        // массивы, не копируя их; движки, кроме all_pairs_flat, строятся по отображённому графу.
+        // checksum описывает входные данные; если он не совпал, файла нет или он испорчен,
+        // LoadSnapshot возвращает nullptr. У RAPTOR графа нет, и снимки для него не пишутся.
+        static std::unique_ptr<TransportRouter> LoadSnapshot(const transport_catalogue::TransportCatalogue& tc,
+                                                             const RoutingSettings& settings,
+                                                             const std::string& path, uint64_t checksum);
+        void SaveSnapshot(const std::string& path, uint64_t checksum) const;
 
-        std::optional<RouteInfo> FindOptimalRoute(const std::string& from, const std::string& to) const;
+        std::optional<RouteInfo> FindOptimalRoute(domain::StopId from, domain::StopId to) const;
 
     private:
+        TransportRouter(const transport_catalogue::TransportCatalogue& tc, const RoutingSettings& settings,
+                        std::unique_ptr<mapped_file::MappedFile> snapshot);
+
         void BuildRouter();
+        void CreateRouter();
+        bool ReadSnapshot(uint64_t checksum);
         void InitializeVertexIds();
-        void AddWaitEdges();
-        void AddBusEdges();
+        void AddWaitEdges(graph::DirectedWeightedGraph<double>& graph);
+        void AddBusEdges(graph::DirectedWeightedGraph<double>& graph);
+        void UpdateRoadToGeoRatio(double geo_distance, int64_t road_distance);
+        double GetTravelTimeLowerBound(graph::VertexId vertex, graph::VertexId target) const;
 
-        std::optional<graph::VertexId> GetStopVertexId(const std::string_view& stop_name) const;
+        std::optional<graph::VertexId> GetStopVertexId(domain::StopId stop) const;
         const EdgeInfo& GetEdgeInfo(graph::EdgeId edge_id) const;
-        std::string_view GetStopNameByVertexId(graph::VertexId vertex_id) const;
+        domain::StopId GetStopByVertexId(graph::VertexId vertex_id) const;
 
         const transport_catalogue::TransportCatalogue& tc_;
         RoutingSettings settings_;
-        std::unique_ptr<graph::DirectedWeightedGraph<double>> graph_;
-        std::unique_ptr<graph::Router<double>> router_;
-        std::unordered_map<std::string_view, graph::VertexId> stop_to_vertex_id_;
-        std::unordered_map<graph::VertexId, std::string_view> vertex_id_to_stop_name_;
-        std::unordered_map<graph::EdgeId, EdgeInfo> edge_id_to_info_;
+        std::unique_ptr<graph::CsrGraph<double>> graph_;
+        std::unique_ptr<graph::RouterBase<double>> router_;
+        std::unique_ptr<RaptorRouter> raptor_router_;
+        // Снимок, в который указывают матрицы загруженного маршрутизатора
+        std::unique_ptr<mapped_file::MappedFile> snapshot_;
+        // Вершина ожидания каждой остановки каталога; у остановок без автобусов вершин нет
+        mapped_file::MappedArray<graph::VertexId> stop_vertex_ids_;
+        // Остановки в порядке вершин: у i-й вершины 2i и 2i + 1
+        mapped_file::MappedArray<domain::StopId> vertex_stops_;
+        mapped_file::MappedArray<EdgeInfo> edge_infos_;
+
+        // Для эвристики A*: остановки на единичной сфере в порядке вершин и минимальное по всем
+        // перегонам отношение дорожного расстояния к расстоянию по прямой
+        mapped_file::MappedArray<geo::UnitVector> stop_vectors_;
+        double min_road_to_geo_ratio_ = 0.0;
     };
 
 }  // namespace router